@@ -0,0 +1,112 @@
+#!/bin/sh
+# Runs make-index on synthetic trees and compares it to bench/baseline.txt.
+# Each tree is built twice: `first` writes everything, and `again` has nothing
+# changed, (SOURCE_DATE_EPOCH is fixed, so @(now) is too.) It reports
+# directories and pages, (index.html written,) a second, bytes written, system
+# calls, and peak resident set; the numbers in brackets are against the
+# baseline. The times only compare on the same machine.
+#
+# Usage: bench/bench.sh [-s] [make-index arguments...]
+# With -s, the results are saved as the baseline. RUNS is how many times each
+# is timed, (3,) and the best is kept. `make bench` builds the tools into
+# build/bench and runs this, with BENCH as the arguments.
+
+here=$(cd "$(dirname "$0")/.." && pwd)
+bin=${MAKE_INDEX:-$here/bin/$(basename "$here")}
+tools=$here/build/bench
+work=$here/build/bench/trees
+baseline=$here/bench/baseline.txt
+save=
+SOURCE_DATE_EPOCH=${SOURCE_DATE_EPOCH:-1700000000}
+export SOURCE_DATE_EPOCH
+[ "$1" = -s ] && { save=1; shift; }
+for t in "$bin" "$tools/tree" "$tools/run"; do
+	[ -x "$t" ] || { echo "$t: not built; run make bench" >&2; exit 1; }
+done
+
+# name: tree arguments
+presets="wide:-d 2 -f 30 -n 20
+deep:-d 8 -f 2 -n 8
+sidecars:-d 3 -f 8 -n 40 -D 80 -l 10 -N 5 -L 24"
+
+runs=${RUNS:-3}
+results=$(mktemp)
+trap 'rm -f "$results"' EXIT
+
+# fresh <tree>: as it was before make-index
+fresh() {
+	find "$1" \( -name index.html -o -name index.html.gz \) -exec rm {} +
+	rm -f "$1/sitemap.xml" "$1/sitemap.xml.gz" "$1/newsfeed.rss" \
+		"$1/newsfeed.rss.gz" "$1/.make-index"
+}
+
+# timed <tree> <name> <pass>: one timed run
+timed() {
+	touch "$work/.marker"
+	m=$("$tools/run" "$1" "$bin" $args) || { echo "$2 $3: failed" >&2; exit 1; }
+	echo "$2 $3 $m pages $(find "$1" -name index.html -newer "$work/.marker" \
+		| wc -l)" >> "$results"
+}
+
+# counted <tree> <name> <pass>: one run counting system calls, if it can
+counted() {
+	c=$("$tools/run" -c "$1" "$bin" $args) || c="syscalls -"
+	echo "$2 $3 $c" >> "$results"
+}
+
+args="$*"
+rm -rf "$work"
+mkdir -p "$work"
+echo "$presets" | while IFS=: read -r name gen; do
+	tree=$work/$name
+	"$tools/tree" $gen "$tree" >/dev/null || exit 1
+	for f in .index.html .sitemap.xml .newsfeed.rss; do
+		cp "$here/example/$f" "$tree/"
+	done
+	echo "$name dirs $(find "$tree" -type d | wc -l)" >> "$results"
+	i=0
+	while [ $i -lt "$runs" ]; do
+		fresh "$tree"
+		timed "$tree" "$name" first
+		timed "$tree" "$name" again
+		i=$((i + 1))
+	done
+	fresh "$tree"
+	counted "$tree" "$name" first
+	counted "$tree" "$name" again
+done
+
+# the best time of the runs, and the worst memory
+awk '$2 == "dirs" { dirs[$1] = $3; next }
+	{ key = $1 " " $2; if(!(key in order)) order[key] = n++ }
+	$3 == "syscalls" { calls[key] = $4; next }
+	{ if(!(key in s) || $4 < s[key]) s[key] = $4;
+		if($6 > rss[key]) rss[key] = $6; bytes[key] = $8; pages[key] = $10 }
+	END { for(key in order) { split(key, k, " ");
+		line[order[key]] = sprintf("%s dirs %d pages %d seconds %s rss %s"\
+		" bytes %s syscalls %s", key, dirs[k[1]], pages[key], s[key], rss[key], bytes[key],
+		(key in calls) ? calls[key] : "-") }
+		for(i = 0; i < n; i++) print line[i] }' "$results" > "$results.all"
+mv "$results.all" "$results"
+
+# name pass dirs D pages P seconds S rss R bytes B syscalls C
+awk -v args="$args" -v baseline="$baseline" 'function delta(now, was) {
+	if(was == "" || was == "-" || now == "-" || was == 0) return "";
+	return sprintf(" (%+.0f%%)", (now - was) * 100 / was) }
+	BEGIN { while((getline line < baseline) > 0)
+		{ split(line, b, " "); base[b[1] " " b[2]] = line } }
+	NR == 1 { printf "make-index %s\n%-9s %-6s %6s %9s %9s %20s %20s %16s\n",
+		args, "tree", "run", "dirs", "dirs/s", "pages/s", "bytes", "syscalls",
+		"peak KiB" }
+	{	key = $1 " " $2; split((key in base) ? base[key] : "", b, " ");
+		ds = $8 > 0 ? $4 / $8 : 0; ps = $8 > 0 ? $6 / $8 : 0;
+		bds = b[8] > 0 ? b[4] / b[8] : 0; bps = b[8] > 0 ? b[6] / b[8] : 0;
+		printf "%-9s %-6s %6d %9.0f %9.0f %20s %20s %16s\n", $1, $2, $4,
+			ds, ps, $12 delta($12, b[12]), $14 delta($14, b[14]),
+			$10 delta($10, b[10]);
+		if(key in base) printf "%-9s %-6s %6s %9s %9s\n", "", "", "",
+			delta(ds, bds), delta(ps, bps) }' "$results"
+[ -f "$baseline" ] || echo "(no baseline; bench/bench.sh -s makes one)"
+if [ -n "$save" ]; then
+	cp "$results" "$baseline" && echo "Saved $baseline."
+fi
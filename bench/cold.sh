@@ -0,0 +1,46 @@
+#!/bin/sh
+# Per-directory latency of make-index on a cold page cache, reading one at a
+# time and with --io-uring. Dropping the cache needs root; otherwise it says so
+# and the numbers are for a warm cache.
+#
+# Usage: bench/cold.sh <tree> [runs] [make-index arguments...]
+# The tree needs the templates at it's root, (see example.) MAKE_INDEX is the
+# programme, by default the one that `make` builds.
+
+here=$(cd "$(dirname "$0")/.." && pwd)
+bin=${MAKE_INDEX:-$here/bin/$(basename "$here")}
+tree=$1
+runs=${2:-5}
+[ $# -gt 2 ] && shift 2 || shift $#
+if [ -z "$tree" ] || [ ! -d "$tree" ]; then
+	echo "Usage: $0 <tree> [runs] [make-index arguments...]" >&2; exit 1
+fi
+[ -x "$bin" ] || { echo "$bin: not built; run make" >&2; exit 1; }
+dirs=$(find "$tree" -type d | wc -l)
+
+cold() {
+	sync
+	if ! echo 3 2>/dev/null > /proc/sys/vm/drop_caches; then
+		[ -n "$warned" ] || echo "(can't drop the page cache; it's warm)" >&2
+		warned=1
+	fi
+}
+
+now() { date +%s%N; }
+
+for mode in "" --io-uring; do
+	total=0
+	i=0
+	while [ $i -lt "$runs" ]; do
+		cold
+		start=$(now)
+		(cd "$tree" && "$bin" $mode "$@" >/dev/null 2>&1) \
+			|| { echo "$bin $mode $*: failed" >&2; exit 1; }
+		end=$(now)
+		total=$((total + end - start))
+		i=$((i + 1))
+	done
+	echo "$total $runs $dirs ${mode:-sync}" | awk '{ printf \
+		"%-11s %8.1f ms/run %8.1f us/directory (%d directories, %d runs)\n", \
+		$4, $1 / $2 / 1e6, $1 / $2 / $3 / 1e3, $3, $2 }'
+done
@@ -0,0 +1,123 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle run
+ @author Neil
+
+ Runs a programme in a directory with the output thrown away, and says how it
+ went in one line: the seconds it took, it's peak resident set in KiB, and the
+ bytes it wrote. With `-c`, it instead counts the system calls of every thread,
+ which is a lot slower, so the time is meaningless.
+
+ @std POSIX.1-2008; the bytes and system calls are from Linux */
+
+#define _DEFAULT_SOURCE /* waitid __WALL */
+#include <stdlib.h> /* EXIT_ */
+#include <stdio.h>  /* printf fopen */
+#include <string.h> /* strcmp */
+#include <errno.h>
+#include <unistd.h> /* fork execvp chdir */
+#include <fcntl.h>  /* open */
+#include <sys/types.h>
+#include <sys/time.h> /* gettimeofday */
+#include <sys/resource.h> /* getrusage */
+#include <sys/wait.h>
+#ifdef __linux__
+#include <signal.h>
+#include <sys/ptrace.h>
+#endif
+
+/* Error reporting. */
+static const char *why;
+
+/** @return The `wchar` of the process `pid`, which must not be reaped yet,
+ or zero if it's not there. */
+static unsigned long written(const pid_t pid) {
+	char fn[64], line[128];
+	unsigned long bytes = 0;
+	FILE *fp;
+	sprintf(fn, "/proc/%ld/io", (long)pid);
+	if(!(fp = fopen(fn, "r"))) return 0;
+	while(fgets(line, sizeof line, fp))
+		if(sscanf(line, "wchar: %lu", &bytes) == 1) break;
+	fclose(fp);
+	return bytes;
+}
+
+#ifdef __linux__ /* <-- linux */
+/** Follows `pid`, which has stopped itself, and all it's threads, counting
+ the system calls, until it exits. @return The count. */
+static unsigned long trace(const pid_t pid, int *const status) {
+	unsigned long stops = 0;
+	pid_t p;
+	int s;
+	ptrace(PTRACE_SETOPTIONS, pid, 0,
+		PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE);
+	ptrace(PTRACE_SYSCALL, pid, 0, 0);
+	while((p = waitpid(-1, &s, __WALL)) != -1) {
+		int sig = 0;
+		if(WIFEXITED(s) || WIFSIGNALED(s)) {
+			if(p == pid) { *status = s; break; }
+			continue;
+		}
+		if(!WIFSTOPPED(s)) continue;
+		if(WSTOPSIG(s) == (SIGTRAP | 0x80)) stops++; /* entry or exit */
+		else if(WSTOPSIG(s) != SIGTRAP && WSTOPSIG(s) != SIGSTOP)
+			sig = WSTOPSIG(s);
+		ptrace(PTRACE_SYSCALL, p, 0, sig);
+	}
+	return (stops + 1) / 2;
+}
+#endif /* linux --> */
+
+int main(int argc, char **argv) {
+	struct timeval start, end;
+	struct rusage ru;
+	siginfo_t info;
+	unsigned long bytes = 0, calls = 0;
+	int i = 1, count = 0, status = 0, null;
+	pid_t pid;
+	if(i < argc && !strcmp(argv[i], "-c")) count = 1, i++;
+	if(i + 1 >= argc) {
+		fprintf(stderr, "Usage: run [-c] <directory> <programme> [args...]\n");
+		return EXIT_FAILURE;
+	}
+	if(gettimeofday(&start, 0)) { why = "time"; goto catch; }
+	if((pid = fork()) == -1) { why = "fork"; goto catch; }
+	if(!pid) {
+		if(chdir(argv[i]) || (null = open("/dev/null", O_WRONLY)) == -1
+			|| dup2(null, STDOUT_FILENO) == -1
+			|| dup2(null, STDERR_FILENO) == -1) _exit(126);
+#ifdef __linux__
+		if(count && (ptrace(PTRACE_TRACEME, 0, 0, 0) == -1
+			|| raise(SIGSTOP))) _exit(126);
+#endif
+		execvp(argv[i + 1], argv + i + 1);
+		_exit(127);
+	}
+#ifdef __linux__
+	if(count) {
+		if(waitpid(pid, &status, 0) == -1) { why = "wait"; goto catch; }
+		calls = trace(pid, &status);
+	} else
+#endif
+	{
+		/* look at it before it's gone */
+		if(waitid(P_PID, (id_t)pid, &info, WEXITED | WNOWAIT) == -1)
+			{ why = "wait"; goto catch; }
+		bytes = written(pid);
+		if(waitpid(pid, &status, 0) == -1) { why = "wait"; goto catch; }
+	}
+	if(gettimeofday(&end, 0) || getrusage(RUSAGE_CHILDREN, &ru))
+		{ why = "time"; goto catch; }
+	if(!WIFEXITED(status) || WEXITSTATUS(status))
+		{ why = argv[i + 1]; errno = ECHILD; goto catch; }
+	if(count) printf("syscalls %lu\n", calls);
+	else printf("seconds %.4f rss %ld bytes %lu\n",
+		(double)(end.tv_sec - start.tv_sec)
+		+ (double)(end.tv_usec - start.tv_usec) / 1e6, ru.ru_maxrss, bytes);
+	return EXIT_SUCCESS;
+catch:
+	perror(why);
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,155 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle tree
+ @author Neil
+
+ Makes a synthetic site under a directory, for the benchmarks. Every
+ directory has `files` files, and, until `depth`, `fanout` sub-directories.
+ Each file has a `.d` description with a chance of `desc` percent, and one
+ in `link` and `news` percent are `.link` and `.news` instead. The names are
+ about `length` characters. It's the same tree for the same `seed`.
+
+ It doesn't put the templates in; see `bench.sh`.
+
+ @std POSIX.1 */
+
+#include <stdlib.h> /* strtoul EXIT_ */
+#include <stdio.h>  /* fopen fprintf sprintf */
+#include <string.h> /* strlen strcmp */
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h> /* mkdir */
+
+static struct {
+	unsigned long depth, fanout, files, desc, link, news, length, seed;
+} option = { 3, 6, 12, 40, 5, 5, 10, 1 };
+
+/* Error reporting. */
+static const char *why;
+
+/* Counts what was made. */
+static unsigned long dirs, files;
+
+/** @return A pseudo-random number in [0, 32767]; ANSI's example. */
+static unsigned long rnd(void) {
+	option.seed = (option.seed * 1103515245ul + 12345ul) & 0xfffffffful;
+	return (option.seed >> 16) & 0x7ffful;
+}
+
+/** @return True with `percent` chance. */
+static int chance(const unsigned long percent) {
+	return rnd() % 100 < percent;
+}
+
+/** Puts a name of about `option.length` letters, ending in `no` so that it's
+ unique, in `name`, which is at least 64. */
+static void naming(char *const name, const unsigned long no) {
+	unsigned long len = option.length ? option.length / 2
+		+ rnd() % (option.length + 1) : 0, i;
+	if(len > 40) len = 40;
+	for(i = 0; i < len; i++) name[i] = (char)('a' + rnd() % 26);
+	sprintf(name + len, "%lu", no);
+}
+
+/** Writes `content` to `dir`/`name`. @return Success. */
+static int put(const char *const dir, const char *const name,
+	const char *const content) {
+	char fn[1024];
+	FILE *fp;
+	if(strlen(dir) + strlen(name) + 2 > sizeof fn)
+		{ errno = ERANGE; why = name; return 0; }
+	strcat(strcat(strcpy(fn, dir), "/"), name);
+	if(!(fp = fopen(fn, "w"))) { why = fn; return 0; }
+	fputs(content, fp);
+	if(fclose(fp) == EOF) { why = fn; return 0; }
+	files++;
+	return 1;
+}
+
+/** Makes the directory `dir` with `level` more below it. @return Success. */
+static int make(const char *const dir, const unsigned long level) {
+	char name[128], side[128], text[256], sub[1024];
+	unsigned long i;
+	if(mkdir(dir, 0777)) { why = dir; return 0; }
+	dirs++;
+	if(chance(option.desc)) {
+		sprintf(text, "The directory %lu of %lu.\n", dirs, level);
+		if(!put(dir, "index.d", text)) return 0;
+	}
+	for(i = 0; i < option.files; i++) {
+		naming(name, i);
+		if(chance(option.news)) {
+			/* the body, and the news about it */
+			sprintf(side, "%s.news", name);
+			sprintf(text, "%04lu-%02lu-%02lu\nNews %s\n", 1990 + rnd() % 40,
+				1 + rnd() % 12, 1 + rnd() % 28, name);
+			if(!put(dir, name, "<p>Something happened.</p>\n")
+				|| !put(dir, side, text)) return 0;
+			continue;
+		}
+		if(chance(option.link)) {
+			sprintf(side, "%s.link", name);
+			sprintf(text, "http://example.com/%s\n", name);
+			if(!put(dir, side, text)) return 0;
+		} else {
+			strcat(name, ".txt");
+			if(!put(dir, name, "Some text.\n")) return 0;
+		}
+		if(chance(option.desc)) {
+			sprintf(side, "%s.d", name);
+			sprintf(text, "A description of %s.\n", name);
+			if(!put(dir, side, text)) return 0;
+		}
+	}
+	if(!level) return 1;
+	for(i = 0; i < option.fanout; i++) {
+		naming(name, i);
+		if(strlen(dir) + strlen(name) + 2 > sizeof sub)
+			{ errno = ERANGE; why = name; return 0; }
+		strcat(strcat(strcpy(sub, dir), "/"), name);
+		if(!make(sub, level - 1)) return 0;
+	}
+	return 1;
+}
+
+static void usage(void) {
+	fprintf(stderr, "Usage: tree [-d depth] [-f fanout] [-n files]"
+		" [-D desc%%] [-l link%%]\n"
+		"	[-N news%%] [-L name length] [-s seed] <new directory>\n"
+		"Defaults: -d %lu -f %lu -n %lu -D %lu -l %lu -N %lu -L %lu -s %lu.\n",
+		option.depth, option.fanout, option.files, option.desc, option.link,
+		option.news, option.length, option.seed);
+}
+
+int main(int argc, char **argv) {
+	int i;
+	for(i = 1; i < argc - 1; i++) {
+		unsigned long *o, n;
+		char *end;
+		if(argv[i][0] != '-' || !argv[i][1] || argv[i][2]) break;
+		switch(argv[i][1]) {
+		case 'd': o = &option.depth; break;
+		case 'f': o = &option.fanout; break;
+		case 'n': o = &option.files; break;
+		case 'D': o = &option.desc; break;
+		case 'l': o = &option.link; break;
+		case 'N': o = &option.news; break;
+		case 'L': o = &option.length; break;
+		case 's': o = &option.seed; break;
+		default: o = 0;
+		}
+		if(!o || i + 1 >= argc - 1
+			|| (n = strtoul(argv[++i], &end, 10), *end))
+			{ why = argv[i]; errno = EDOM; goto catch; }
+		*o = n;
+	}
+	if(i != argc - 1) { why = "tree"; errno = EDOM; goto catch; }
+	if(!make(argv[i], option.depth)) goto catch;
+	printf("%lu directories, %lu files.\n", dirs, files);
+	return EXIT_SUCCESS;
+catch:
+	perror(why);
+	usage();
+	return EXIT_FAILURE;
+}
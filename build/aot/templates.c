@@ -0,0 +1,230 @@
+/* Generated by ParserCompile; the templates that this is used for are
+ exactly these. */
+
+#include <stdio.h>
+#include "Parser.h"
+#include "Text.h"
+#include "Widget.h"
+
+static const char template0[] = {
+	60, 33, 100, 111, 99, 116, 121, 112, 101, 32, 104, 116,
+	109, 108, 32, 112, 117, 98, 108, 105, 99, 32, 34, 45,
+	47, 47, 87, 51, 67, 47, 47, 68, 84, 68, 32, 72,
+	84, 77, 76, 32, 52, 46, 48, 49, 47, 47, 69, 78,
+	34, 32, 34, 104, 116, 116, 112, 58, 47, 47, 119, 119,
+	119, 46, 119, 51, 46, 111, 114, 103, 47, 84, 82, 47,
+	104, 116, 109, 108, 52, 47, 115, 116, 114, 105, 99, 116,
+	46, 100, 116, 100, 34, 62, 10, 10, 60, 104, 116, 109,
+	108, 62, 10, 10, 60, 104, 101, 97, 100, 62, 10, 60,
+	116, 105, 116, 108, 101, 62, 65, 114, 114, 33, 32, 64,
+	40, 112, 119, 100, 41, 123, 47, 125, 60, 47, 116, 105,
+	116, 108, 101, 62, 10, 60, 109, 101, 116, 97, 32, 110,
+	97, 109, 101, 32, 61, 32, 34, 67, 111, 110, 116, 101,
+	110, 116, 45, 116, 121, 112, 101, 34, 32, 104, 116, 116,
+	112, 45, 101, 113, 117, 105, 118, 32, 61, 32, 34, 67,
+	111, 110, 116, 101, 110, 116, 45, 84, 121, 112, 101, 34,
+	32, 99, 111, 110, 116, 101, 110, 116, 32, 61, 32, 34,
+	116, 101, 120, 116, 47, 104, 116, 109, 108, 59, 32, 99,
+	104, 97, 114, 115, 101, 116, 61, 117, 115, 45, 97, 115,
+	99, 105, 105, 34, 62, 10, 60, 109, 101, 116, 97, 32,
+	110, 97, 109, 101, 32, 61, 32, 34, 75, 101, 121, 119,
+	111, 114, 100, 115, 34, 32, 99, 111, 110, 116, 101, 110,
+	116, 32, 61, 32, 34, 64, 40, 112, 119, 100, 41, 123,
+	44, 32, 125, 97, 114, 114, 34, 62, 10, 60, 109, 101,
+	116, 97, 32, 110, 97, 109, 101, 32, 61, 32, 34, 65,
+	117, 116, 104, 111, 114, 34, 32, 99, 111, 110, 116, 101,
+	110, 116, 32, 61, 32, 34, 78, 101, 105, 108, 34, 62,
+	10, 60, 109, 101, 116, 97, 32, 110, 97, 109, 101, 32,
+	61, 32, 34, 71, 101, 110, 101, 114, 97, 116, 111, 114,
+	34, 32, 99, 111, 110, 116, 101, 110, 116, 32, 61, 32,
+	34, 84, 104, 105, 115, 32, 112, 114, 105, 115, 116, 105,
+	110, 101, 32, 99, 111, 100, 101, 32, 108, 105, 101, 115,
+	32, 117, 110, 109, 97, 114, 114, 101, 100, 32, 98, 121,
+	32, 105, 110, 102, 97, 110, 116, 105, 108, 101, 32, 101,
+	100, 105, 116, 111, 114, 115, 33, 34, 62, 10, 60, 47,
+	104, 101, 97, 100, 62, 10, 10, 60, 98, 111, 100, 121,
+	62, 10, 60, 112, 62, 10, 68, 97, 116, 101, 58, 32,
+	64, 40, 110, 111, 119, 41, 10, 60, 47, 112, 62, 10,
+	60, 112, 62, 10, 64, 40, 99, 111, 110, 116, 101, 110,
+	116, 41, 60, 47, 112, 62, 10, 60, 117, 108, 62, 10,
+	64, 40, 102, 105, 108, 101, 115, 41, 123, 60, 108, 105,
+	62, 10, 60, 105, 109, 103, 32, 115, 114, 99, 32, 61,
+	32, 34, 64, 40, 102, 105, 108, 101, 105, 99, 111, 110,
+	41, 34, 32, 97, 108, 116, 32, 61, 32, 34, 91, 32,
+	64, 40, 102, 105, 108, 101, 97, 108, 116, 41, 32, 93,
+	34, 62, 32, 84, 104, 105, 115, 32, 105, 115, 32, 116,
+	104, 101, 32, 60, 97, 32, 104, 114, 101, 102, 32, 61,
+	32, 34, 64, 40, 102, 105, 108, 101, 104, 114, 101, 102,
+	41, 34, 62, 64, 40, 102, 105, 108, 101, 110, 97, 109,
+	101, 41, 60, 47, 97, 62, 59, 10, 100, 101, 115, 99,
+	105, 112, 116, 105, 111, 110, 58, 32, 64, 40, 102, 105,
+	108, 101, 100, 101, 115, 99, 41, 60, 47, 108, 105, 62,
+	10, 125, 60, 47, 117, 108, 62, 10, 60, 112, 62, 10,
+	70, 114, 111, 109, 32, 104, 116, 116, 112, 58, 47, 47,
+	115, 111, 109, 101, 116, 104, 105, 110, 103, 47, 64, 40,
+	112, 119, 100, 41, 123, 47, 125, 32, 111, 114, 32, 47,
+	32, 105, 115, 32, 64, 40, 114, 111, 111, 116, 41, 123,
+	47, 125, 46, 10, 60, 47, 112, 62, 10, 60, 47, 98,
+	111, 100, 121, 62, 10, 10, 60, 47, 104, 116, 109, 108,
+	62, 10, 0,
+};
+static void template0_0(struct Text *const out,
+	struct Files *const f, struct Widget *const w) {
+	(void)out, (void)f, (void)w;
+	TextCat(out, template0 + 0, 119);
+	while(WidgetPwd(f, out, w)) {
+		TextCat(out, template0 + 126, 1);
+	}
+	TextCat(out, template0 + 128, 141);
+	while(WidgetPwd(f, out, w)) {
+		TextCat(out, template0 + 276, 2);
+	}
+	TextCat(out, template0 + 279, 165);
+	while(WidgetNow(f, out, w));
+	TextCat(out, template0 + 450, 10);
+	while(WidgetContent(f, out, w));
+	TextCat(out, template0 + 470, 10);
+	while(WidgetFiles(f, out, w)) {
+		TextCat(out, template0 + 489, 17);
+		while(WidgetFileicon(f, out, w));
+		TextCat(out, template0 + 517, 11);
+		while(WidgetFilealt(f, out, w));
+		TextCat(out, template0 + 538, 28);
+		while(WidgetFilehref(f, out, w));
+		TextCat(out, template0 + 577, 2);
+		while(WidgetFilename(f, out, w));
+		TextCat(out, template0 + 590, 18);
+		while(WidgetFiledesc(f, out, w));
+		TextCat(out, template0 + 619, 6);
+	}
+	TextCat(out, template0 + 626, 32);
+	while(WidgetPwd(f, out, w)) {
+		TextCat(out, template0 + 665, 1);
+	}
+	TextCat(out, template0 + 667, 9);
+	while(WidgetRoot(f, out, w)) {
+		TextCat(out, template0 + 684, 1);
+	}
+	TextCat(out, template0 + 686, 24);
+}
+static const ParserSection template0_sections[] = {&template0_0};
+static const char template1[] = {
+	60, 63, 120, 109, 108, 32, 118, 101, 114, 115, 105, 111,
+	110, 32, 61, 32, 34, 49, 46, 48, 34, 32, 101, 110,
+	99, 111, 100, 105, 110, 103, 32, 61, 32, 34, 85, 84,
+	70, 45, 56, 34, 32, 63, 62, 10, 60, 33, 68, 79,
+	67, 84, 89, 80, 69, 32, 114, 115, 115, 62, 10, 10,
+	60, 114, 115, 115, 32, 118, 101, 114, 115, 105, 111, 110,
+	32, 61, 32, 34, 50, 46, 48, 34, 62, 60, 99, 104,
+	97, 110, 110, 101, 108, 62, 10, 9, 60, 116, 105, 116,
+	108, 101, 62, 65, 114, 114, 60, 47, 116, 105, 116, 108,
+	101, 62, 10, 9, 60, 100, 101, 115, 99, 114, 105, 112,
+	116, 105, 111, 110, 62, 89, 97, 97, 114, 114, 114, 44,
+	32, 110, 101, 119, 115, 32, 102, 114, 111, 109, 32, 97,
+	102, 97, 114, 46, 60, 47, 100, 101, 115, 99, 114, 105,
+	112, 116, 105, 111, 110, 62, 10, 9, 60, 108, 97, 110,
+	103, 117, 97, 103, 101, 62, 101, 110, 60, 47, 108, 97,
+	110, 103, 117, 97, 103, 101, 62, 10, 9, 60, 112, 117,
+	98, 100, 97, 116, 101, 62, 64, 40, 110, 111, 119, 41,
+	60, 47, 112, 117, 98, 100, 97, 116, 101, 62, 10, 9,
+	60, 108, 97, 115, 116, 98, 117, 105, 108, 100, 100, 97,
+	116, 101, 62, 64, 40, 110, 111, 119, 41, 60, 47, 108,
+	97, 115, 116, 98, 117, 105, 108, 100, 100, 97, 116, 101,
+	62, 10, 10, 126, 10, 9, 60, 105, 116, 101, 109, 62,
+	10, 9, 9, 60, 116, 105, 116, 108, 101, 62, 64, 40,
+	116, 105, 116, 108, 101, 41, 60, 47, 116, 105, 116, 108,
+	101, 62, 10, 9, 9, 60, 108, 105, 110, 107, 62, 64,
+	40, 112, 119, 100, 41, 123, 47, 125, 64, 40, 110, 101,
+	119, 115, 110, 97, 109, 101, 41, 60, 47, 108, 105, 110,
+	107, 62, 10, 9, 9, 60, 100, 101, 115, 99, 114, 105,
+	112, 116, 105, 111, 110, 62, 10, 64, 40, 110, 101, 119,
+	115, 41, 9, 9, 60, 47, 100, 101, 115, 99, 114, 105,
+	112, 116, 105, 111, 110, 62, 10, 9, 9, 60, 97, 117,
+	116, 104, 111, 114, 62, 78, 101, 105, 108, 60, 47, 97,
+	117, 116, 104, 111, 114, 62, 10, 9, 9, 60, 112, 117,
+	98, 100, 97, 116, 101, 62, 64, 40, 100, 97, 116, 101,
+	41, 60, 47, 112, 117, 98, 100, 97, 116, 101, 62, 10,
+	9, 60, 47, 105, 116, 101, 109, 62, 10, 10, 126, 10,
+	60, 47, 99, 104, 97, 110, 110, 101, 108, 62, 60, 47,
+	114, 115, 115, 62, 10, 0,
+};
+static void template1_0(struct Text *const out,
+	struct Files *const f, struct Widget *const w) {
+	(void)out, (void)f, (void)w;
+	TextCat(out, template1 + 0, 198);
+	while(WidgetNow(f, out, w));
+	TextCat(out, template1 + 204, 27);
+	while(WidgetNow(f, out, w));
+	TextCat(out, template1 + 237, 18);
+}
+static void template1_1(struct Text *const out,
+	struct Files *const f, struct Widget *const w) {
+	(void)out, (void)f, (void)w;
+	TextCat(out, template1 + 257, 17);
+	while(WidgetTitle(f, out, w));
+	TextCat(out, template1 + 282, 17);
+	while(WidgetPwd(f, out, w)) {
+		TextCat(out, template1 + 306, 1);
+	}
+	while(WidgetNewsname(f, out, w));
+	TextCat(out, template1 + 319, 24);
+	while(WidgetNews(f, out, w));
+	TextCat(out, template1 + 350, 52);
+	while(WidgetDate(f, out, w));
+	TextCat(out, template1 + 409, 21);
+}
+static void template1_2(struct Text *const out,
+	struct Files *const f, struct Widget *const w) {
+	(void)out, (void)f, (void)w;
+	TextCat(out, template1 + 432, 17);
+}
+static const ParserSection template1_sections[] = {&template1_0, &template1_1, &template1_2};
+static const char template2[] = {
+	60, 63, 120, 109, 108, 32, 118, 101, 114, 115, 105, 111,
+	110, 32, 61, 32, 34, 49, 46, 48, 34, 32, 101, 110,
+	99, 111, 100, 105, 110, 103, 32, 61, 32, 34, 85, 84,
+	70, 45, 56, 34, 32, 63, 62, 10, 60, 33, 68, 79,
+	67, 84, 89, 80, 69, 32, 120, 109, 108, 62, 10, 10,
+	60, 117, 114, 108, 115, 101, 116, 32, 120, 109, 108, 110,
+	115, 32, 61, 32, 34, 104, 116, 116, 112, 58, 47, 47,
+	119, 119, 119, 46, 103, 111, 111, 103, 108, 101, 46, 99,
+	111, 109, 47, 115, 99, 104, 101, 109, 97, 115, 47, 115,
+	105, 116, 101, 109, 97, 112, 47, 48, 46, 56, 52, 34,
+	62, 10, 126, 10, 60, 117, 114, 108, 62, 10, 9, 60,
+	108, 111, 99, 62, 104, 116, 116, 112, 58, 47, 47, 115,
+	111, 109, 101, 116, 104, 105, 110, 103, 47, 64, 40, 112,
+	119, 100, 41, 123, 47, 125, 60, 47, 108, 111, 99, 62,
+	10, 9, 60, 108, 97, 115, 116, 109, 111, 100, 62, 64,
+	40, 110, 111, 119, 41, 60, 47, 108, 97, 115, 116, 109,
+	111, 100, 62, 10, 60, 47, 117, 114, 108, 62, 10, 126,
+	10, 60, 47, 117, 114, 108, 115, 101, 116, 62, 10, 0,
+};
+static void template2_0(struct Text *const out,
+	struct Files *const f, struct Widget *const w) {
+	(void)out, (void)f, (void)w;
+	TextCat(out, template2 + 0, 122);
+}
+static void template2_1(struct Text *const out,
+	struct Files *const f, struct Widget *const w) {
+	(void)out, (void)f, (void)w;
+	TextCat(out, template2 + 124, 29);
+	while(WidgetPwd(f, out, w)) {
+		TextCat(out, template2 + 160, 1);
+	}
+	TextCat(out, template2 + 162, 17);
+	while(WidgetNow(f, out, w));
+	TextCat(out, template2 + 185, 18);
+}
+static void template2_2(struct Text *const out,
+	struct Files *const f, struct Widget *const w) {
+	(void)out, (void)f, (void)w;
+	TextCat(out, template2 + 205, 10);
+}
+static const ParserSection template2_sections[] = {&template2_0, &template2_1, &template2_2};
+
+const struct ParserCompiled parser_compiled[] = {
+	{ template0, 710, 1, template0_sections },
+	{ template1, 449, 3, template1_sections },
+	{ template2, 215, 3, template2_sections },
+};
+const size_t parser_compiled_size = 3;
@@ -0,0 +1,368 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Batch
+ @author Neil
+
+ `Batch` puts all the `statx`, or all the small reads, that one directory
+ needs on an io_uring, so that there are up to `depth` in flight at once,
+ instead of waiting for every one in turn. On a cold cache, or on a network
+ file-system, that's the difference between one round trip per file and one
+ per batch.
+
+ It talks to the kernel directly, without `liburing`. A `Batch` must only be
+ used on one thread at a time. If io_uring is not there, or doesn't have the
+ operations, <fn:Batch> returns null and the caller goes on as it was. If
+ the kernel fails in the middle, what's in flight is waited for before it
+ returns; if it can't be, the `Batch` fails from then on.
+
+ @std Linux; elsewhere, <fn:Batch> always fails */
+
+#define _DEFAULT_SOURCE /* syscall MAP_POPULATE */
+#include <stdlib.h> /* malloc free */
+#include <string.h> /* memset */
+#include <errno.h>
+#include <assert.h>
+#include "Batch.h"
+
+#ifdef __linux__ /* <-- linux */
+
+#include <unistd.h>      /* syscall close */
+#include <fcntl.h>       /* O_RDONLY */
+#include <sys/mman.h>    /* mmap munmap */
+#include <sys/syscall.h> /* __NR_io_uring_* */
+#include <linux/stat.h>  /* struct statx */
+#include <linux/io_uring.h>
+
+/* The mode bits of a directory and a regular file. */
+static const unsigned mode_type = 0170000, mode_dir = 0040000,
+	mode_file = 0100000;
+
+struct Batch {
+	int fd;
+	unsigned entries;
+	struct { void *map; size_t size; unsigned *head, *tail, *mask, *array; } sq;
+	struct { void *map; size_t size; unsigned *head, *tail, *mask;
+		struct io_uring_cqe *cqes; } cq;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	int is_dead; /* requests couldn't be waited for, so it's not used again */
+};
+
+/** Sets up `sqe` for the `i`th request. @return Whether there is one. */
+typedef int (*Prep)(struct io_uring_sqe *const sqe, const size_t i,
+	void *const param);
+
+/** Destructor. */
+void Batch_(struct Batch **const b_ptr) {
+	struct Batch *b;
+	if(!b_ptr || !(b = *b_ptr)) return;
+	if(b->sqes) munmap(b->sqes, b->sqes_size);
+	if(b->cq.map && b->cq.map != b->sq.map) munmap(b->cq.map, b->cq.size);
+	if(b->sq.map) munmap(b->sq.map, b->sq.size);
+	if(b->fd != -1) close(b->fd);
+	free(b);
+	*b_ptr = 0;
+}
+
+/** @return Whether the ring `fd` can do all the operations we need. */
+static int probe(const int fd) {
+	static const unsigned char need[]
+		= { IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE };
+	const unsigned ops = 256;
+	struct io_uring_probe *p;
+	size_t i;
+	int ok = 0;
+	if(!(p = calloc(1, sizeof *p + ops * sizeof *p->ops))) return 0;
+	if(syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, p, ops) < 0)
+		goto finally;
+	for(i = 0; i < sizeof need; i++) if(need[i] > p->last_op
+		|| !(p->ops[need[i]].flags & IO_URING_OP_SUPPORTED)) goto finally;
+	ok = 1;
+finally:
+	free(p);
+	return ok;
+}
+
+/** @return A ring with room for `depth` requests in flight, or null if io_uring
+ is not available. @throws[malloc, io_uring_setup, mmap, ENOSYS] */
+struct Batch *Batch(const unsigned depth) {
+	struct io_uring_params par;
+	struct Batch *b;
+	char *sq, *cq;
+	if(!(b = malloc(sizeof *b))) return 0;
+	b->fd = -1, b->entries = 0, b->is_dead = 0;
+	b->sq.map = b->cq.map = 0, b->sqes = 0;
+	memset(&par, 0, sizeof par);
+	if((b->fd = (int)syscall(__NR_io_uring_setup, depth ? depth : 1, &par))
+		< 0) { b->fd = -1; goto catch; }
+	if(!probe(b->fd)) { errno = ENOSYS; goto catch; }
+	b->entries = par.sq_entries;
+	b->sq.size = par.sq_off.array + par.sq_entries * sizeof(unsigned);
+	b->cq.size = par.cq_off.cqes
+		+ par.cq_entries * sizeof(struct io_uring_cqe);
+	if(par.features & IORING_FEAT_SINGLE_MMAP) {
+		if(b->cq.size > b->sq.size) b->sq.size = b->cq.size;
+		b->cq.size = b->sq.size;
+	}
+	if((b->sq.map = mmap(0, b->sq.size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, b->fd, IORING_OFF_SQ_RING)) == MAP_FAILED)
+		{ b->sq.map = 0; goto catch; }
+	if(par.features & IORING_FEAT_SINGLE_MMAP) b->cq.map = b->sq.map;
+	else if((b->cq.map = mmap(0, b->cq.size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, b->fd, IORING_OFF_CQ_RING)) == MAP_FAILED)
+		{ b->cq.map = 0; goto catch; }
+	b->sqes_size = par.sq_entries * sizeof(struct io_uring_sqe);
+	if((b->sqes = mmap(0, b->sqes_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, b->fd, IORING_OFF_SQES)) == MAP_FAILED)
+		{ b->sqes = 0; goto catch; }
+	sq = b->sq.map, cq = b->cq.map;
+	b->sq.head  = (unsigned *)(void *)(sq + par.sq_off.head);
+	b->sq.tail  = (unsigned *)(void *)(sq + par.sq_off.tail);
+	b->sq.mask  = (unsigned *)(void *)(sq + par.sq_off.ring_mask);
+	b->sq.array = (unsigned *)(void *)(sq + par.sq_off.array);
+	b->cq.head  = (unsigned *)(void *)(cq + par.cq_off.head);
+	b->cq.tail  = (unsigned *)(void *)(cq + par.cq_off.tail);
+	b->cq.mask  = (unsigned *)(void *)(cq + par.cq_off.ring_mask);
+	b->cq.cqes  = (struct io_uring_cqe *)(void *)(cq + par.cq_off.cqes);
+	return b;
+catch:
+	{ const int e = errno; Batch_(&b); errno = e; }
+	return 0;
+}
+
+/** Puts the results of the requests that are done on `b` in `res`.
+ @return How many. */
+static size_t reap(struct Batch *const b, const size_t count, int *const res) {
+	unsigned head, i;
+	head = *b->cq.head;
+	__sync_synchronize();
+	for(i = head; i != *b->cq.tail; i++) {
+		const struct io_uring_cqe *const cqe = b->cq.cqes + (i & *b->cq.mask);
+		assert(cqe->user_data < count);
+		res[cqe->user_data] = cqe->res;
+	}
+	__sync_synchronize();
+	*b->cq.head = i;
+	return i - head;
+}
+
+/** After `io_uring_enter` failed on `b`, takes back what the kernel hasn't
+ seen, and waits for the rest of `inflight`, so that nothing is written after
+ it returns, and nothing is left for the next. If it can't wait, `b` is dead.
+ @return False. */
+static int drain(struct Batch *const b, size_t inflight, const size_t count,
+	int *const res) {
+	const int e = errno;
+	unsigned head = *b->sq.head;
+	inflight -= *b->sq.tail - head;
+	*b->sq.tail = head;
+	__sync_synchronize();
+	for(inflight -= reap(b, count, res); inflight;
+		inflight -= reap(b, count, res)) {
+		if(syscall(__NR_io_uring_enter, b->fd, 0u, 1u, IORING_ENTER_GETEVENTS,
+			(void *)0, 0ul) >= 0 || errno == EINTR) continue;
+		b->is_dead = 1;
+		break;
+	}
+	errno = e;
+	return 0;
+}
+
+/** Runs `count` requests made by `prep` through `b`, keeping as many in flight
+ as fit, and puts the result of each in `res`. @return Success; on failure,
+ none are left in flight, unless `b` is dead.
+ @throws[io_uring_enter, EIO] */
+static int run(struct Batch *const b, const size_t count, const Prep prep,
+	void *const param, int *const res) {
+	size_t next = 0, inflight = 0;
+	unsigned tail;
+	long ret;
+	assert(b && prep && res);
+	if(b->is_dead) { errno = EIO; return 0; }
+	while(next < count || inflight) {
+		/* fill the submission ring */
+		tail = *b->sq.tail;
+		while(next < count && inflight < b->entries) {
+			struct io_uring_sqe *const sqe = b->sqes + (tail & *b->sq.mask);
+			memset(sqe, 0, sizeof *sqe);
+			if(!prep(sqe, next, param)) { next++; continue; }
+			sqe->user_data = next++;
+			b->sq.array[tail & *b->sq.mask] = tail & *b->sq.mask;
+			tail++, inflight++;
+		}
+		if(!inflight) break;
+		__sync_synchronize();
+		*b->sq.tail = tail;
+		__sync_synchronize();
+		/* submit what the kernel hasn't seen and wait for at least one */
+		ret = syscall(__NR_io_uring_enter, b->fd, tail - *b->sq.head, 1u,
+			IORING_ENTER_GETEVENTS, (void *)0, 0ul);
+		if(ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			return drain(b, inflight, count, res);
+		inflight -= reap(b, count, res);
+	}
+	return 1;
+}
+
+struct stat_param {
+	int dirfd;
+	const char *const*names;
+	struct statx *stx;
+};
+
+/** @implements Prep */
+static int prep_stat(struct io_uring_sqe *const sqe, const size_t i,
+	void *const param) {
+	struct stat_param *const p = param;
+	sqe->opcode = IORING_OP_STATX;
+	sqe->fd = p->dirfd;
+	sqe->addr = (unsigned long)p->names[i];
+	sqe->len = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME;
+	sqe->off = (unsigned long)(p->stx + i);
+	return 1;
+}
+
+/** Fills `stats` with the `count` `names` in `dirfd`, following links, like
+ `fstatat`. @return Success; individual files can still have `error`.
+ @throws[malloc, io_uring_enter, EIO] */
+int BatchStat(struct Batch *const b, const int dirfd, const size_t count,
+	const char *const*const names, struct BatchStat *const stats) {
+	struct stat_param p;
+	int *res = 0;
+	size_t i;
+	int success = 0;
+	if(!b || !names || !stats) { errno = EDOM; return 0; }
+	if(!count) return 1;
+	p.dirfd = dirfd, p.names = names;
+	if(!(p.stx = malloc(sizeof *p.stx * count))
+		|| !(res = malloc(sizeof *res * count))) goto finally;
+	if(!run(b, count, &prep_stat, &p, res)) {
+		/* the kernel could still write them */
+		if(b->is_dead) p.stx = 0;
+		goto finally;
+	}
+	for(i = 0; i < count; i++) {
+		struct BatchStat *const s = stats + i;
+		const struct statx *const x = p.stx + i;
+		if((s->error = res[i] < 0 ? -res[i] : 0)) continue;
+		s->isDir  = (x->stx_mode & mode_type) == mode_dir;
+		s->isFile = (x->stx_mode & mode_type) == mode_file;
+		s->size   = (unsigned long)x->stx_size;
+		s->mtime  = (unsigned long)x->stx_mtime.tv_sec;
+	}
+	success = 1;
+finally:
+	free(res);
+	free(p.stx);
+	return success;
+}
+
+struct read_param {
+	int dirfd;
+	const char *const*names;
+	char *const*bufs;
+	const size_t *sizes;
+	int *fds;
+};
+
+/** @implements Prep */
+static int prep_open(struct io_uring_sqe *const sqe, const size_t i,
+	void *const param) {
+	struct read_param *const p = param;
+	sqe->opcode = IORING_OP_OPENAT;
+	sqe->fd = p->dirfd;
+	sqe->addr = (unsigned long)p->names[i];
+	sqe->open_flags = O_RDONLY;
+	return 1;
+}
+
+/** @implements Prep */
+static int prep_read(struct io_uring_sqe *const sqe, const size_t i,
+	void *const param) {
+	struct read_param *const p = param;
+	if(p->fds[i] < 0) return 0;
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = p->fds[i];
+	sqe->addr = (unsigned long)p->bufs[i];
+	sqe->len = (unsigned)p->sizes[i];
+	sqe->off = 0;
+	return 1;
+}
+
+/** @implements Prep */
+static int prep_close(struct io_uring_sqe *const sqe, const size_t i,
+	void *const param) {
+	struct read_param *const p = param;
+	if(p->fds[i] < 0) return 0;
+	sqe->opcode = IORING_OP_CLOSE;
+	sqe->fd = p->fds[i];
+	return 1;
+}
+
+/** Reads the first `sizes` bytes of each of the `count` `names` in `dirfd`
+ into `bufs`; each of `errors` is zero if it got all of them, or the `errno`.
+ @return Success; individual files can still have errors.
+ @throws[malloc, io_uring_enter, EIO] */
+int BatchRead(struct Batch *const b, const int dirfd, const size_t count,
+	const char *const*const names, char *const*const bufs,
+	const size_t *const sizes, int *const errors) {
+	struct read_param p;
+	int *res = 0;
+	size_t i;
+	int success = 0;
+	if(!b || !names || !bufs || !sizes || !errors) { errno = EDOM; return 0; }
+	if(!count) return 1;
+	p.dirfd = dirfd, p.names = names, p.bufs = bufs, p.sizes = sizes;
+	if(!(p.fds = malloc(sizeof *p.fds * count))
+		|| !(res = malloc(sizeof *res * count))) goto finally;
+	/* all the opens, then all the reads, then all the closes */
+	for(i = 0; i < count; i++) p.fds[i] = -EBADF;
+	if(!run(b, count, &prep_open, &p, p.fds)) goto close;
+	for(i = 0; i < count; i++) res[i] = -EBADF;
+	if(!run(b, count, &prep_read, &p, res)) goto close;
+	for(i = 0; i < count; i++) errors[i] = p.fds[i] < 0 ? -p.fds[i]
+		: res[i] < 0 ? -res[i] : (size_t)res[i] != sizes[i] ? EIO : 0;
+	success = 1;
+close:
+	if(!run(b, count, &prep_close, &p, res))
+		for(i = 0; i < count; i++) if(p.fds[i] >= 0) close(p.fds[i]);
+finally:
+	free(res);
+	free(p.fds);
+	return success;
+}
+
+#else /* linux --><-- !linux */
+
+struct Batch { int unused; };
+
+/** Not available. @return Null. @throws[ENOSYS] */
+struct Batch *Batch(const unsigned depth) {
+	(void)depth;
+	errno = ENOSYS;
+	return 0;
+}
+
+/** Destructor. */
+void Batch_(struct Batch **const b_ptr) { if(b_ptr) *b_ptr = 0; }
+
+/** Not available. @return False. @throws[ENOSYS] */
+int BatchStat(struct Batch *const b, const int dirfd, const size_t count,
+	const char *const*const names, struct BatchStat *const stats) {
+	(void)b, (void)dirfd, (void)count, (void)names, (void)stats;
+	errno = ENOSYS;
+	return 0;
+}
+
+/** Not available. @return False. @throws[ENOSYS] */
+int BatchRead(struct Batch *const b, const int dirfd, const size_t count,
+	const char *const*const names, char *const*const bufs,
+	const size_t *const sizes, int *const errors) {
+	(void)b, (void)dirfd, (void)count, (void)names, (void)bufs, (void)sizes,
+		(void)errors;
+	errno = ENOSYS;
+	return 0;
+}
+
+#endif /* !linux --> */
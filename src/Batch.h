@@ -0,0 +1,16 @@
+struct Batch;
+
+/** What <fn:BatchStat> finds out about a file; `error` is the `errno`, or
+ zero, in which case the rest is valid. */
+struct BatchStat {
+	int error, isDir, isFile;
+	unsigned long size, mtime;
+};
+
+struct Batch *Batch(const unsigned depth);
+void Batch_(struct Batch **const b_ptr);
+int BatchStat(struct Batch *const b, const int dirfd, const size_t count,
+	const char *const*const names, struct BatchStat *const stats);
+int BatchRead(struct Batch *const b, const int dirfd, const size_t count,
+	const char *const*const names, char *const*const bufs,
+	const size_t *const sizes, int *const errors);
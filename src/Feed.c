@@ -0,0 +1,119 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Feed
+ @author Neil
+
+ A `Feed` keeps the newest `max` news items that are added to it, in a
+ min-heap ordered by ISO 8601 date, so that the oldest is the one that is
+ thrown away. Items on the same date are ordered by where they are, so the
+ same tree always gives the same feed, no matter in what order it was read.
+ When it's done, <fn:FeedSort> puts them newest first.
+
+ @std C89/90 */
+
+#include <stdlib.h> /* malloc free qsort */
+#include <string.h> /* strlen strcpy strcmp */
+#include <errno.h>
+#include <assert.h>
+#include "Feed.h"
+
+struct Feed {
+	struct FeedItem *data;
+	size_t size, max;
+	int sorted;
+};
+
+/** @return Positive if `a` goes before `b` in the feed: newer, or, on the
+ same day, first by place. */
+static int cmp(const struct FeedItem *const a, const struct FeedItem *const b) {
+	int c;
+	if(a->year != b->year) return a->year > b->year ? 1 : -1;
+	if(a->month != b->month) return a->month > b->month ? 1 : -1;
+	if(a->day != b->day) return a->day > b->day ? 1 : -1;
+	if((c = strcmp(a->dir, b->dir))) return -c;
+	return -strcmp(a->name, b->name);
+}
+
+/** Newest first. @implements qsort */
+static int sort_cmp(const void *a, const void *b) { return -cmp(a, b); }
+
+/** @return An empty feed that keeps at most `max`, or null.
+ @throws[malloc, EDOM] */
+struct Feed *Feed(const size_t max) {
+	struct Feed *f;
+	if(!max) { errno = EDOM; return 0; }
+	if(!(f = malloc(sizeof *f))) return 0;
+	f->data = 0, f->size = 0, f->max = max, f->sorted = 0;
+	return f;
+}
+
+/** Destructor. */
+void Feed_(struct Feed **const f_ptr) {
+	struct Feed *f;
+	size_t i;
+	if(!f_ptr || !(f = *f_ptr)) return;
+	for(i = 0; i < f->size; i++) free((void *)(size_t)f->data[i].dir);
+	free(f->data);
+	free(f);
+	*f_ptr = 0;
+}
+
+/** Moves the item at `i` in `f` down the heap to where it goes. */
+static void sift_down(struct Feed *const f, size_t i) {
+	const struct FeedItem item = f->data[i];
+	size_t child;
+	while((child = (i << 1) + 1) < f->size) {
+		if(child + 1 < f->size
+			&& cmp(f->data + child + 1, f->data + child) < 0) child++;
+		if(cmp(f->data + child, &item) >= 0) break;
+		f->data[i] = f->data[child], i = child;
+	}
+	f->data[i] = item;
+}
+
+/** Moves the item at `i` in `f` up the heap to where it goes. */
+static void sift_up(struct Feed *const f, size_t i) {
+	const struct FeedItem item = f->data[i];
+	size_t parent;
+	while(i && cmp(&item, f->data + (parent = (i - 1) >> 1)) < 0)
+		f->data[i] = f->data[parent], i = parent;
+	f->data[i] = item;
+}
+
+/** Offers a copy of `item` to `f`; if it's full, it takes the place of the
+ oldest, if it's newer. @return Success; not being kept is not an error.
+ @throws[malloc] */
+int FeedAdd(struct Feed *const f, const struct FeedItem *const item) {
+	char *dir;
+	if(!f || !item || !item->dir || f->sorted) { errno = EDOM; return 0; }
+	if(f->size == f->max && cmp(item, f->data) <= 0) return 1;
+	if(!(dir = malloc(strlen(item->dir) + 1))) return 0;
+	strcpy(dir, item->dir);
+	if(f->size < f->max) {
+		if(!f->data && !(f->data = malloc(sizeof *f->data * f->max)))
+			{ free(dir); return 0; }
+		f->data[f->size] = *item, f->data[f->size].dir = dir;
+		sift_up(f, f->size++);
+	} else {
+		free((void *)(size_t)f->data[0].dir);
+		f->data[0] = *item, f->data[0].dir = dir;
+		sift_down(f, 0);
+	}
+	return 1;
+}
+
+/** Puts `f` newest first; after this, nothing can be added.
+ @return The number of items. */
+size_t FeedSort(struct Feed *const f) {
+	if(!f) return 0;
+	if(!f->sorted) qsort(f->data, f->size, sizeof *f->data, &sort_cmp);
+	f->sorted = 1;
+	return f->size;
+}
+
+/** @return The `i`th item of `f` after <fn:FeedSort>, or null. */
+const struct FeedItem *FeedGet(const struct Feed *const f, const size_t i) {
+	if(!f || !f->sorted || i >= f->size) return 0;
+	return f->data + i;
+}
@@ -0,0 +1,15 @@
+/** A news item; `dir` is the directory it's in, relative to the root, with
+ a `/` after every one, so it's empty at the root. */
+struct FeedItem {
+	int year, month, day;
+	char title[64], name[64];
+	const char *dir;
+};
+
+struct Feed;
+
+struct Feed *Feed(const size_t max);
+void Feed_(struct Feed **const f_ptr);
+int FeedAdd(struct Feed *const f, const struct FeedItem *const item);
+size_t FeedSort(struct Feed *const f);
+const struct FeedItem *FeedGet(const struct Feed *const f, const size_t i);
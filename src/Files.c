@@ -4,212 +4,724 @@
  @subtitle Files
  @author Neil
 
- `Files` is a list of `File`, the `Files` can have
- a relation to other Files by `parent` and `favourite`.
+ `Files` is a list of `File`, the `Files` can have a relation to other Files by
+ `parent`. Every `Files` holds its directory open and everything is relative to
+ that, never the working directory, so that more than one can be in use at the
+ same time; the parents are only read. The list is one array, sorted once, and
+ the names are in one block, so a directory is freed all at once.
 
- @std POSIX.1 */
+ The directory is listed once, and every name goes into a hash table, so that
+ asking whether there's a description, icon, or link, is a lookup, not an
+ `open` that fails. Directories are known from `d_type` without `stat`.
+ Sidecars, (descriptions, links, and news,) are read into memory the first
+ time they're asked for, and after that come from there. Given a `Batch`, all
+ the entries are `statx`ed at once, and the small sidecars are all read at
+ once. Given `Stats`, the listing, status, and filter are timed. A file has a
+ total, it's size, one, and it's modification; a directory only has one when
+ it's given, after whoever is reading the tree has been through it.
 
+ A directory can have an `.indexignore`, with the rules of <fn:Ignore>, which
+ go down to the directories under it. What it leaves out is never `stat`ed,
+ given to the filter, or on the list, so a directory that's left out is never
+ opened.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
 #include <stdlib.h>   /* malloc free */
-#include <stdio.h>    /* fprintf */
-#include <string.h>   /* strcmp strstr */
+#include <stdio.h>    /* fprintf fmemopen */
+#include <string.h>   /* strcmp strchr memcpy */
+#include <ctype.h>    /* tolower */
 #include <dirent.h>   /* opendir readdir closedir */
-#include <sys/stat.h> /* fstat */
+#include <sys/stat.h> /* fstatat */
+#include <fcntl.h>    /* openat */
+#include <unistd.h>   /* close dup read faccessat */
+#include <errno.h>
 #include <assert.h>
+#include "Hash.h"
+#include "Batch.h"
+#include "Stats.h"
+#include "Ignore.h"
 #include "Files.h"
 
 /* constants */
 const char          *dir_current = "."; /* used in multiple files */
 const char          *dir_parent  = "..";
+const char          *ignore_file = ".indexignore";
 static const size_t max_filename = 128;
+static const size_t max_sidecar  = 8192; /* bigger are read when needed */
+/* in Widget.c */
+extern const char *dot_desc, *dot_news, *dot_link;
 
 /* public */
 struct Files {
 	struct Files *parent;    /* the parent, could be 0 */
-	struct Files *favourite; /* temp var used to access a certain child */
-	struct File  *file;      /* THIS dir, could be 0 if it's home */
-	struct File  *firstFile; /* the Files in this dir */
-	struct File  *firstDir;  /* the Files in this dir that are dirs */
-	struct File  *this;      /* temp var, one of the firstDir, firstFile list */
+	const struct File *file; /* THIS dir, could be 0 if it's home */
+	struct { struct File *data; size_t size, capacity; } list; /* dirs first */
+	size_t       this;       /* temp var, one past the selected in `list` */
+	struct { size_t first, size; } page; /* of `list`, for FilesAdvance */
+	size_t       depth;      /* the number of parents */
+	size_t       path;       /* temp var, the depth FilesEnumPath is at */
+	int          fd;         /* the directory, everything is relative to it */
+	unsigned long inputs;    /* digest of everything the page depends on */
+	struct { char *data; size_t size, capacity; } names; /* the listing */
+	struct { struct Entry *data; size_t size, capacity; } entry;
+	struct { size_t *data; size_t size; } slot; /* hash of `entry`, +1 */
+	char         *cache;     /* the sidecars read in a `Batch` */
+	struct Ignore *rules;    /* of this directory, or null */
+	const struct Ignore *ignore; /* `rules`, or of the parent */
 };
 /* private */
 struct File {
-	struct File *next;
-	char *name;
-	int size;
-	int isDir;
+	const char *name; /* in `names` of the `Files` */
+	const char *key;  /* only while sorting */
+	size_t order;     /* in the listing, the same */
+	struct FilesTotal total; /* of a file, or what's under a directory */
+	int isDir, isTotal; /* directories only have a total from the caller */
+};
+/* A name in the listing; the `data` of sidecars is read at most once. */
+struct Entry {
+	size_t name; /* in `names` */
+	unsigned long hash;
+	enum { Unknown, Directory, Regular } type;
+	enum { Unread, Cached, Owned, Uncached } state;
+	const char *data;
+	size_t size;
+	int is_ignored; /* by an `.indexignore` */
 };
 
-/* private */
-static struct File *File(const char *name, const int size, const int isDir);
-static void File_(struct File *file);
-static int FileInsert(struct File *file, struct File **startAddr);
+/** Puts `name` on the list of `files`, and it's status into the inputs. */
+static void include(struct Files *const files, const char *const name,
+	const int isDir, const unsigned long size, const unsigned long mtime) {
+	struct File *file;
+	/* directories only show their name; the description is a dependency */
+	files->inputs = HashString(files->inputs, name);
+	if(isDir) files->inputs = HashNumber(files->inputs, 1);
+	else files->inputs = HashNumber(HashNumber(files->inputs, size), mtime);
+	if(strlen(name) > max_filename) { fprintf(stderr, "File: file name"
+		" \"%s\" is too long (%lu.)\n", name, (unsigned long)max_filename);
+		return; }
+	if(files->list.size >= files->list.capacity) {
+		size_t c = files->list.capacity ? files->list.capacity << 1 : 32;
+		struct File *data;
+		if(!(data = realloc(files->list.data, sizeof *data * c))) {
+			fprintf(stderr, "Files: <%s> missed being included on the "
+			"list.\n", name); return;
+		}
+		files->list.data = data, files->list.capacity = c;
+	}
+	file = files->list.data + files->list.size;
+	file->name  = name;
+	file->key   = 0;
+	file->order = files->list.size++;
+	file->total.bytes  = isDir ? 0 : size;
+	file->total.files  = isDir ? 0 : 1;
+	file->total.newest = isDir ? 0 : mtime;
+	file->isDir = isDir;
+	file->isTotal = !isDir;
+}
 
-/** Directory information.
- @param[parent] `parent->this` must be the 'file' (directory) that you want to
- create.
- @param[filter] This returns true on the files that you want included. */
-struct Files *Files(struct Files *const parent, const FilesFilter filter) {
-	const char    *dirName;
+/** Directories, then case-insensitive, then the last read first.
+ @implements qsort */
+static int file_cmp(const void *a, const void *b) {
+	const struct File *const x = a, *const y = b;
+	int c;
+	if(x->isDir != y->isDir) return x->isDir ? -1 : 1;
+	if((c = strcmp(x->key, y->key))) return c;
+	return x->order < y->order ? 1 : x->order > y->order ? -1 : 0;
+}
+
+/** Sorts the list of `files` once; the keys are the names in lower-case, so
+ the comparison is `strcmp`, but ordered the same as `strcasecmp`.
+ @return Success. */
+static int sort(struct Files *const files) {
+	char *keys, *k;
+	const char *a;
+	size_t i, total = 0;
+	if(files->list.size < 2) return 1;
+	for(i = 0; i < files->list.size; i++)
+		total += strlen(files->list.data[i].name) + 1;
+	if(!(keys = malloc(total))) return 0;
+	for(k = keys, i = 0; i < files->list.size; i++) {
+		files->list.data[i].key = k;
+		for(a = files->list.data[i].name;
+			(*k++ = (char)tolower((unsigned char)*a)); a++);
+	}
+	qsort(files->list.data, files->list.size, sizeof *files->list.data,
+		&file_cmp);
+	for(i = 0; i < files->list.size; i++) files->list.data[i].key = 0;
+	free(keys);
+	return 1;
+}
+
+/** @return Whether `name` ends in `ext`. */
+static int ends(const char *const name, const char *const ext) {
+	const size_t n = strlen(name), e = strlen(ext);
+	return n > e && !strcmp(name + n - e, ext);
+}
+
+/** @return Whether `name` is something the widgets will read. */
+static int is_sidecar(const char *const name) {
+	return ends(name, dot_desc) || ends(name, dot_link) || ends(name, dot_news);
+}
+
+/** @return The name of `e` in `files`. */
+static const char *entry_name(const struct Files *const files,
+	const struct Entry *const e) {
+	return files->names.data + e->name;
+}
+
+/** @return The entry in the listing of `files` called `fn`, or null. */
+static struct Entry *lookup(const struct Files *const files,
+	const char *const fn) {
+	const unsigned long hash = HashString(0, fn);
+	size_t i, e;
+	if(!files || !files->slot.size) return 0;
+	for(i = hash & (files->slot.size - 1); (e = files->slot.data[i]);
+		i = (i + 1) & (files->slot.size - 1)) {
+		struct Entry *const entry = files->entry.data + e - 1;
+		if(entry->hash == hash && !strcmp(entry_name(files, entry), fn))
+			return entry;
+	}
+	return 0;
+}
+
+/** Reads the sidecar `e` in `files` into memory, if it hasn't been.
+ @return Whether it's in memory. */
+static int load(struct Files *const files, struct Entry *const e) {
+	struct stat st;
+	char *data = 0;
+	size_t got = 0;
+	ssize_t rd;
+	int fd;
+	if(e->state == Cached || e->state == Owned) return 1;
+	if(e->state == Uncached) return 0;
+	e->state = Uncached;
+	if(e->type == Directory || !is_sidecar(entry_name(files, e))
+		&& strcmp(entry_name(files, e), ignore_file)) return 0;
+	if((fd = openat(files->fd, entry_name(files, e), O_RDONLY)) == -1)
+		return 0;
+	if(fstat(fd, &st) || !S_ISREG(st.st_mode)
+		|| !(data = malloc((size_t)st.st_size + 1))) goto finally;
+	while(got < (size_t)st.st_size) {
+		if((rd = read(fd, data + got, (size_t)st.st_size - got)) == -1)
+			{ if(errno == EINTR) continue; goto finally; }
+		if(!rd) break;
+		got += (size_t)rd;
+	}
+	e->data = data, e->size = got, e->state = Owned, data = 0;
+finally:
+	free(data);
+	close(fd);
+	return e->state == Owned;
+}
+
+/** Reads all the small sidecars in the listing of `files` with `batch`, given
+ their `stats`. If it fails, they're read when they're needed.
+ @return Success. */
+static int prefetch(struct Files *const files, struct Batch *const batch,
+	const struct BatchStat *const stats) {
+	const size_t count = files->entry.size;
+	const char **want = 0;
+	char **bufs = 0, *a;
+	size_t *sizes = 0, *which = 0, total = 0, n = 0, i, j;
+	int *errors = 0, success = 0;
+	/* which ones, and how much room */
+	for(i = 0; i < count; i++) {
+		if(stats[i].error || !stats[i].isFile || stats[i].size > max_sidecar
+			|| !is_sidecar(entry_name(files, files->entry.data + i))) continue;
+		total += stats[i].size, n++;
+	}
+	if(!n) return 1;
+	if(!(want = malloc(sizeof *want * n)) || !(bufs = malloc(sizeof *bufs * n))
+		|| !(sizes = malloc(sizeof *sizes * n))
+		|| !(which = malloc(sizeof *which * n))
+		|| !(errors = malloc(sizeof *errors * n))
+		|| !(files->cache = malloc(total + 1))) goto finally;
+	for(a = files->cache, i = j = 0; i < count; i++) {
+		const char *const name = entry_name(files, files->entry.data + i);
+		if(stats[i].error || !stats[i].isFile || stats[i].size > max_sidecar
+			|| !is_sidecar(name)) continue;
+		want[j] = name, bufs[j] = a, sizes[j] = stats[i].size, which[j] = i;
+		a += sizes[j++];
+	}
+	assert(j == n);
+	if(!BatchRead(batch, files->fd, n, want, bufs, sizes, errors))
+		goto finally;
+	for(j = 0; j < n; j++) {
+		struct Entry *const e = files->entry.data + which[j];
+		if(errors[j]) continue;
+		e->data = bufs[j], e->size = sizes[j], e->state = Cached;
+	}
+	success = 1;
+finally:
+	if(!success) free(files->cache), files->cache = 0;
+	free(errors);
+	free(which);
+	free(sizes);
+	free(bufs);
+	free(want);
+	return success;
+}
+
+/** Reads all the names in `d` into `files` and makes the hash table.
+ @return Success. @throws[realloc, readdir] */
+static int list(struct Files *const files, DIR *const d) {
 	struct dirent *de;
-	struct stat   st;
-	struct File   *file;
-	struct Files  *files;
-	DIR           *dir;
-	assert(!parent || parent->this);
-	if(!(files = malloc(sizeof *files))) { Files_(files); return 0; }
-	/* does not check for recusive dirs - assumes that it is a tree */
-	files->parent    = parent;
-	files->favourite = 0;
-	files->file      = parent ? parent->this : 0;
-	files->firstFile = 0;
-	files->firstDir  = 0;
-	files->this      = 0;
-	/* print path on stderr */
-	FilesSetPath(files);
-	fprintf(stderr, "Files: directory <");
-	while((dirName = FilesEnumPath(files))) fprintf(stderr, "%s/", dirName);
-	fprintf(stderr, ">.\n");
-	/* read the current dir */
-	dir = opendir(dir_current);
-	if(!dir) { perror(dir_parent); Files_(files); return 0; }
-	while((de = readdir(dir))) {
-		int error = 0;
+	size_t i, slots;
+	errno = 0;
+	while((de = readdir(d))) {
+		const size_t len = strlen(de->d_name) + 1;
+		struct Entry *e;
+		if(len == 1) continue;
+		if(files->names.size + len > files->names.capacity) {
+			size_t c = files->names.capacity ? files->names.capacity : 4096;
+			char *data;
+			while(c < files->names.size + len) c <<= 1;
+			if(!(data = realloc(files->names.data, c))) return 0;
+			files->names.data = data, files->names.capacity = c;
+		}
+		if(files->entry.size >= files->entry.capacity) {
+			size_t c = files->entry.capacity ? files->entry.capacity << 1 : 64;
+			struct Entry *data;
+			if(!(data = realloc(files->entry.data, sizeof *data * c)))
+				return 0;
+			files->entry.data = data, files->entry.capacity = c;
+		}
+		e = files->entry.data + files->entry.size++;
+		memcpy(files->names.data + files->names.size, de->d_name, len);
+		e->name = files->names.size;
+		e->hash = HashString(0, de->d_name);
+		e->type = Unknown;
+#ifdef DT_DIR /* not POSIX, but most have it */
+		if(de->d_type == DT_DIR) e->type = Directory;
+		else if(de->d_type == DT_REG) e->type = Regular;
+#endif
+		e->state = Unread;
+		e->data = 0, e->size = 0;
+		e->is_ignored = 0;
+		files->names.size += len;
+		errno = 0;
+	}
+	if(errno) return 0;
+	/* open addressing, at most half full */
+	for(slots = 16; slots < files->entry.size << 1; slots <<= 1);
+	if(!(files->slot.data = calloc(slots, sizeof *files->slot.data)))
+		return 0;
+	files->slot.size = slots;
+	for(i = 0; i < files->entry.size; i++) {
+		size_t s = files->entry.data[i].hash & (slots - 1);
+		while(files->slot.data[s]) s = (s + 1) & (slots - 1);
+		files->slot.data[s] = i + 1;
+	}
+	return 1;
+}
+
+/** Reads the `.indexignore` of `files`, if it has one, on top of the rules of
+ it's parent, and marks the entries that are left out. @return Success.
+ @throws[malloc] */
+static int ignore(struct Files *const files) {
+	const struct Files *f;
+	struct Entry *e;
+	struct stat st;
+	char *path;
+	size_t len = 0, longest = 0, size, i;
+	int is_dir;
+	files->ignore = files->parent ? files->parent->ignore : 0;
+	e = lookup(files, ignore_file);
+	if(!files->ignore && !e) return 1;
+	/* the directory from the root, and room for the entries after it */
+	for(f = files; f->parent; f = f->parent) len += strlen(f->file->name) + 1;
+	for(i = 0; i < files->entry.size; i++) if((size = strlen(entry_name(files,
+		files->entry.data + i))) > longest) longest = size;
+	if(!(path = malloc(len + longest + 2))) return 0;
+	path[size = len ? len - 1 : 0] = '\0';
+	for(f = files; f->parent; f = f->parent) {
+		const size_t n = strlen(f->file->name);
+		memcpy(path + (size -= n), f->file->name, n);
+		if(size) path[--size] = '/';
+	}
+	if(e && load(files, e) && !(files->rules = Ignore(files->ignore, path,
+		e->data, e->size))) { free(path); return 0; }
+	if(files->rules) files->ignore = files->rules;
+	if(len) path[len - 1] = '/';
+	for(i = 0; i < files->entry.size; i++) {
+		e = files->entry.data + i;
+		strcpy(path + len, entry_name(files, e));
+		e->is_ignored = IgnoreIs(files->ignore, path, e->type == Directory);
+		/* it only matters if it's a directory when there's a rule for that */
+		if(e->type != Unknown
+			|| e->is_ignored == IgnoreIs(files->ignore, path, 1)) continue;
+		is_dir = !fstatat(files->fd, entry_name(files, e), &st, 0)
+			&& S_ISDIR(st.st_mode);
+		if(is_dir) e->is_ignored = !e->is_ignored;
+	}
+	free(path);
+	return 1;
+}
+
+/** Goes through the listing of `files`, in order, with `filter`, and puts the
+ ones that pass on the list, except the ones that are ignored. With a
+ `batch`, they are all `statx`ed first; otherwise, or if that fails, `stat` is
+ only called on the ones that aren't obviously directories. @return Success. */
+static int entries(struct Files *const files, struct Batch *const batch,
+	struct Stats *const time, const FilesFilter filter, void *const param) {
+	static const struct BatchStat none;
+	struct BatchStat *stats = 0;
+	struct stat st;
+	const char **names = 0;
+	size_t i, n;
+	double t;
+	int success = 0, is;
+	if(batch && files->entry.size) {
+		if(!(names = malloc(sizeof *names * files->entry.size))
+			|| !(stats = malloc(sizeof *stats * files->entry.size)))
+			goto finally;
+		for(i = n = 0; i < files->entry.size; i++)
+			if(!files->entry.data[i].is_ignored)
+				names[n++] = entry_name(files, files->entry.data + i);
+		t = StatsStart(time);
+		is = BatchStat(batch, files->fd, n, names, stats);
+		StatsStop(time, StatsStat, t, n);
+		if(is) {
+			/* back to where they are in the listing */
+			for(i = files->entry.size; i; i--)
+				stats[i - 1] = files->entry.data[i - 1].is_ignored ? none
+				: stats[--n];
+			/* the sidecars are read for the filter */
+			t = StatsStart(time);
+			if(!prefetch(files, batch, stats)) perror("sidecars");
+			StatsStop(time, StatsFilter, t, 0);
+		} else {
+			/* it goes on without, one at a time */
+			free(stats), stats = 0;
+		}
+	}
+	for(i = 0; i < files->entry.size; i++) {
+		struct Entry *const e = files->entry.data + i;
+		const char *const name = entry_name(files, e);
+		if(e->is_ignored) continue;
 		/* ignore certain files, incomplete 'files'! -> Recusor.c */
-		if(!*de->d_name || (filter && !filter(files, de->d_name))) continue;
+		if(filter) {
+			t = StatsStart(time);
+			is = filter(files, name, param);
+			StatsStop(time, StatsFilter, t, 1);
+			if(!is) continue;
+		}
 		/* get status of the file */
-		if(stat(de->d_name, &st)) { perror(de->d_name); continue; }
-		/* get the File(name, size) (in KB) */
-		file = File(de->d_name,
-			((int)st.st_size + 512) >> 10, S_ISDIR(st.st_mode));
-		if(!file) error = -1;
-		/* put it in the appropriate spot */
-		if(file->isDir) {
-			if(!FileInsert(file, &files->firstDir))  error = -1;
+		if(stats) {
+			if(stats[i].error)
+				{ errno = stats[i].error; perror(name); continue; }
+			include(files, name, stats[i].isDir, stats[i].size,
+				stats[i].mtime);
+		} else if(e->type == Directory) {
+			include(files, name, 1, 0, 0);
 		} else {
-			if(!FileInsert(file, &files->firstFile)) error = -1;
+			t = StatsStart(time);
+			is = !fstatat(files->fd, name, &st, 0);
+			StatsStop(time, StatsStat, t, 1);
+			if(!is) { perror(name); continue; }
+			include(files, name, S_ISDIR(st.st_mode),
+				(unsigned long)st.st_size, (unsigned long)st.st_mtime);
 		}
-		/* error */
-		if(error) fprintf(stderr, "Files: <%s> missed being included on the "
-			"list.\n", de->d_name);
 	}
-	if(closedir(dir)) { perror(dir_current); }
+	success = 1;
+finally:
+	free(stats);
+	free(names);
+	return success;
+}
+
+/** Directory information.
+ @param[root] Where the root is, a directory or `AT_FDCWD`; only used when
+ `parent` is null.
+ @param[parent] The parent, or null for the root.
+ @param[dir] Must be a directory in `parent`, <fn:FilesThis>; ignored at the
+ root.
+ @param[batch] If not null, this is used to get the status and sidecars of the
+ whole directory at once.
+ @param[stats] If not null, this is where the time goes.
+ @param[filter] This returns true on the files that you want included.
+ @param[param] Passed to `filter`. */
+struct Files *Files(const int root, struct Files *const parent,
+	const struct File *const dir, struct Batch *const batch,
+	struct Stats *const stats, const FilesFilter filter, void *const param) {
+	struct Files  *files;
+	DIR           *d;
+	double        t;
+	int           fd;
+	assert(!parent || dir);
+	if(!(files = malloc(sizeof *files))) return 0;
+	/* does not check for recusive dirs - assumes that it is a tree */
+	files->parent    = parent;
+	files->file      = parent ? dir : 0;
+	files->list.data = 0, files->list.size = files->list.capacity = 0;
+	files->this      = 0;
+	files->page.first = 0, files->page.size = 0;
+	files->depth     = parent ? parent->depth + 1 : 0;
+	files->path      = 0;
+	files->inputs    = 0;
+	files->names.data = 0, files->names.size = files->names.capacity = 0;
+	files->entry.data = 0, files->entry.size = files->entry.capacity = 0;
+	files->slot.data = 0, files->slot.size = 0;
+	files->cache     = 0;
+	files->rules     = 0;
+	files->ignore    = 0;
+	t = StatsStart(stats);
+	files->fd = parent ? openat(parent->fd, dir->name, O_RDONLY | O_DIRECTORY)
+		: openat(root, dir_current, O_RDONLY | O_DIRECTORY);
+	/* read the dir; `closedir` closes the copy */
+	if(files->fd == -1 || (fd = dup(files->fd)) == -1) {
+		perror(parent ? dir->name : dir_current); Files_(files); return 0; }
+	if(!(d = fdopendir(fd))) {
+		perror(parent ? dir->name : dir_current);
+		close(fd); Files_(files); return 0;
+	}
+	if(!list(files, d)) {
+		perror(parent ? dir->name : dir_current);
+		closedir(d); Files_(files); return 0;
+	}
+	if(closedir(d)) { perror(dir_current); }
+	StatsStop(stats, StatsList, t, files->entry.size);
+	if(!ignore(files) || !entries(files, batch, stats, filter, param)
+		|| !sort(files)) {
+		perror(parent ? dir->name : dir_current);
+		Files_(files); return 0;
+	}
 	return files;
 }
 
 /** Destructor. */
 void Files_(struct Files *files) {
 	if(!files) return;
-	File_(files->firstDir); /* cascading delete */
-	File_(files->firstFile);
+	if(files->fd != -1 && close(files->fd)) perror("Files");
+	free(files->list.data);
+	if(files->entry.data) {
+		size_t i;
+		for(i = 0; i < files->entry.size; i++)
+			if(files->entry.data[i].state == Owned)
+				free((void *)(size_t)files->entry.data[i].data);
+	}
+	free(files->entry.data);
+	free(files->slot.data);
+	free(files->names.data);
+	free(files->cache);
+	Ignore_(&files->rules);
 	free(files);
 }
 
-/** This is how we access the files sequentially. */
+/** Puts `fn`, a file that isn't in the root listing `files` yet but will be
+ by the time anyone reads it, on the list where it would be, if it's not
+ ignored and passes `filter` with `param`; `fn` must last as long as `files`.
+ It has no size or time. If it is already there, it's not touched.
+ @return Success. @throws[malloc] */
+int FilesExpect(struct Files *const files, const char *const fn,
+	const FilesFilter filter, void *const param) {
+	assert(files && !files->parent && fn && !strchr(fn, '/'));
+	if(lookup(files, fn) || IgnoreIs(files->ignore, fn, 0)
+		|| filter && !filter(files, fn, param)) return 1;
+	include(files, fn, 0, 0, 0);
+	return sort(files);
+}
+
+/** Adds the name, size, and modification time of `fn`, or that it doesn't
+ exist, to the inputs of `files`; these are files that the page reads but that
+ aren't on the list, like descriptions. */
+void FilesDepend(struct Files *const files, const char *const fn) {
+	struct stat st;
+	if(!files || !fn) return;
+	files->inputs = HashString(files->inputs, fn);
+	if(!strchr(fn, '/') && !lookup(files, fn)
+		|| fstatat(files->fd, fn, &st, 0))
+		{ files->inputs = HashNumber(files->inputs, 0); return; }
+	files->inputs = HashNumber(HashNumber(HashNumber(files->inputs, 2),
+		(unsigned long)st.st_size), (unsigned long)st.st_mtime);
+}
+
+/** @return A digest of the entries of `files` and everything added with
+ <fn:FilesDepend>. */
+unsigned long FilesInputs(const struct Files *const files) {
+	return files ? files->inputs : 0;
+}
+
+/** @return The directory that `files` is listing; everything in
+ <fn:FilesOpen> is relative to it, or, if it's null, the working directory. */
+int FilesFd(const struct Files *const files) {
+	return files ? files->fd : AT_FDCWD;
+}
+
+/** @return Whether `fn` is in the directory of `files`; if it's in the
+ directory itself, this comes from the listing. */
+int FilesHas(const struct Files *const files, const char *const fn) {
+	assert(fn);
+	if(files && !strchr(fn, '/')) return !!lookup(files, fn);
+	return !faccessat(FilesFd(files), fn, F_OK, 0);
+}
+
+/** Reads all of the sidecar `fn` in the directory of `files`; it's read at
+ most once. @return The contents, valid while `files` is, with the size in
+ `size`, or null if it's not there, or not a sidecar. */
+const char *FilesRead(struct Files *const files, const char *const fn,
+	size_t *const size) {
+	struct Entry *e;
+	assert(fn && size);
+	if(!(e = lookup(files, fn)) || !load(files, e)) return 0;
+	*size = e->size;
+	return e->data;
+}
+
+/** Opens `fn` relative to the directory of `files` for reading, or, with a
+ `mode` of `"w"`, for writing. Reading something that's not in the listing
+ fails without asking, and sidecars are read from memory.
+ @return The stream or null. @throws[openat, fdopen, ENOENT] */
+FILE *FilesOpen(struct Files *const files, const char *const fn,
+	const char *const mode) {
+	const int w = mode && *mode == 'w';
+	FILE *fp;
+	int fd;
+	assert(fn);
+	if(!w && files && !strchr(fn, '/')) {
+		struct Entry *e;
+		if(!(e = lookup(files, fn))) { errno = ENOENT; return 0; }
+		if(load(files, e) && (fp = fmemopen((void *)(size_t)e->data,
+			e->size, "r"))) return fp;
+	}
+	if((fd = openat(FilesFd(files), fn,
+		w ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY, 0666)) == -1) return 0;
+	if(!(fp = fdopen(fd, w ? "w" : "r"))) close(fd);
+	return fp;
+}
+
+/** This is how we access the files sequentially; directories first. After
+ the last, it returns false and starts again. It only goes over the page from
+ <fn:FilesSetPage>, if there is one. */
 int FilesAdvance(struct Files *f) {
-	static enum { files, dirs } type = dirs;
+	size_t end;
 	if(!f) return 0;
-	switch(type) {
-		case dirs:
-			if(!f->this) f->this = f->firstDir;
-			else         f->this = f->this->next;
-			if((f->this)) return -1;
-			type = files;
-		case files:
-			if(!f->this) f->this = f->firstFile;
-			else         f->this = f->this->next;
-			if((f->this)) return -1;
-			type = dirs;
+	end = f->list.size;
+	if(f->page.size) {
+		if(f->this < f->page.first) f->this = f->page.first;
+		if(f->page.size < end - f->page.first)
+			end = f->page.first + f->page.size;
 	}
+	if(f->this < end) return f->this++, -1;
+	f->this = 0;
 	return 0;
 }
 
+/** @return How many are on the list of `f`. */
+size_t FilesCount(const struct Files *f) {
+	return f ? f->list.size : 0;
+}
+
+/** Makes <fn:FilesAdvance> go over only `size` of the list of `f`, starting
+ at `first`, so one listing can be shown a page at a time; a `size` of zero is
+ all of them again. */
+void FilesSetPage(struct Files *f, const size_t first, const size_t size) {
+	if(!f) return;
+	f->this = 0;
+	f->page.first = first < f->list.size ? first : f->list.size;
+	f->page.size = size;
+}
+
+/** @return The directory at the top of `f`, that has no parent. */
+int FilesRootFd(const struct Files *f) {
+	if(!f) return AT_FDCWD;
+	while(f->parent) f = f->parent;
+	return f->fd;
+}
+
 /** Doesn't have a parent? */
 int FilesIsRoot(const struct Files *f) {
 	if(!f) return 0;
 	return (f->parent) ? 0 : -1;
 }
 
-/** Resets the list of favourites. */
+/** Starts enumerating the path with <fn:FilesEnumPath>; only `f` is touched,
+ not the parents. */
 void FilesSetPath(struct Files *f) {
 	if(!f) return;
-	for( ; f->parent; f = f->parent) f->parent->favourite = f;
+	f->path = 1;
 }
 
-/** @return After \see{FilesSetPath}, this enumerates them. */
+/** @return After \see{FilesSetPath}, this enumerates them from the root, and
+ then null. */
 const char *FilesEnumPath(struct Files *const files) {
-	struct Files *f = files;
-	const char *name;
+	const struct Files *f = files;
+	size_t up;
 	if(!f) return 0;
-	for( ; f->parent && f->parent->favourite; f = f->parent);
-	if(!f->favourite) return 0; /* clear favourite, done */
-	name = f->favourite->file ? f->favourite->file->name : "(wtf?)";
-	f->favourite = 0;
-	return name;
+	if(!files->path || files->path > files->depth)
+		{ files->path = 0; return 0; } /* done */
+	for(up = files->depth - files->path; up; up--) f = f->parent;
+	files->path++;
+	return f->file ? f->file->name : "(wtf?)";
+}
+
+/** @return The selected file, to pass to <fn:Files> if it's a directory. It
+ stays valid as long as `files`. */
+const struct File *FilesThis(const struct Files *const files) {
+	return files && files->this ? files->list.data + files->this - 1 : 0;
 }
 
 /** @return The file name of the selected file. */
 const char *FilesName(const struct Files *const files) {
-	if(!files || !files->this) return 0;
-	return files->this->name;
+	const struct File *const file = FilesThis(files);
+	return file ? file->name : 0;
 }
 
-/** @return File size of the selected file in KB. */
+/** @return File size of the selected file in KB, or of everything under it,
+ if it's a directory with a total. */
 int FilesSize(const struct Files *files) {
-	if(!files || !files->this) return 0;
-	return files->this->size;
+	const struct File *const file = FilesThis(files);
+	return file ? (int)((file->total.bytes + 512) >> 10) : 0;
 }
 
 /** @return Whether the file is a directory. */
 int FilesIsDir(const struct Files *files) {
-	if(!files || !files->this) return 0;
-	return files->this->isDir;
+	const struct File *const file = FilesThis(files);
+	return file ? file->isDir : 0;
 }
 
-/* private */
+/** @return What's in the selected file, or under it, if it's a directory that
+ was given a total by <fn:FilesSetTotal>, or null. */
+const struct FilesTotal *FilesGetTotal(const struct Files *const files) {
+	const struct File *const file = FilesThis(files);
+	return file && file->isTotal ? &file->total : 0;
+}
 
-static struct File *File(const char *name, const int size, const int isDir) {
-	size_t len;
+/** Sets what's under `dir`, which is a directory on the list of `files`, to
+ `total`, once it's been added up with <fn:FilesSum>. */
+void FilesSetTotal(struct Files *const files, const struct File *const dir,
+	const struct FilesTotal *const total) {
 	struct File *file;
-	if(!name || !*name) { fprintf(stderr, "File: file has no name.\n");
-		return 0; }
-	if((len = strlen(name)) > max_filename) { fprintf(stderr, "File: file name"
-		" \"%s\" is too long (%lu.)\n", name, max_filename); return 0; }
-	file = malloc(sizeof(struct File) + (len + 1));
-	if(!file) { File_(file); return 0; }
-	file->next  = 0;
-	file->name  = (char *)(file + 1);
-	strncpy(file->name, name, len + 1);
-	file->size  = size;
-	file->isDir = isDir;
-	return file;
-}
-
-static void File_(struct File *file) {
-	struct File *next;
-	/* delete ALL the list of files (not just the one) */
-	for( ; file; file = next) {
-		next = file->next;
-		free(file);
-	}
-}
-
-static int FileInsert(struct File *file, struct File **startAddr) {
-	struct File *start;
-	struct File *prev = 0, *ptr = 0;
-	if(!file || !startAddr)
-		{ fprintf(stderr, "FileInsert: file is null.\n"); return 0; }
-	if(file->next)
-		{ fprintf(stderr, "FileInsert: <%s> is already in some other list.\n",
-		file->name); return 0; }
-	start = (struct File *)*startAddr;
-	/* 'prev' is where to insert; 'ptr' is next node */
-	for(prev = 0, ptr = start; ptr; prev = ptr, ptr = ptr->next) {
-		/* 4.4BSD, POSIX.1-2001 :[ */
-		if(strcasecmp(file->name, ptr->name) <= 0) break;
-	}
-	file->next = ptr;
-	if(!prev) start = file;
-	else prev->next = file;
-	*startAddr = start;
-	return -1;
+	assert(files && dir && total && dir >= files->list.data
+		&& dir < files->list.data + files->list.size && dir->isDir);
+	file = files->list.data + (dir - files->list.data);
+	file->total = *total;
+	file->isTotal = 1;
+}
+
+/** Adds up everything on the list of `files` into `total`: the files, and the
+ directories that have a total. */
+void FilesSum(const struct Files *const files, struct FilesTotal *const total) {
+	const struct File *file, *end;
+	assert(files && total);
+	total->bytes = total->files = total->newest = 0;
+	for(file = files->list.data, end = file + files->list.size; file < end;
+		file++) {
+		if(!file->isTotal) continue;
+		total->bytes += file->total.bytes;
+		total->files += file->total.files;
+		if(file->total.newest > total->newest)
+			total->newest = file->total.newest;
+	}
+}
+
+/** Adds the total of the selected directory of `files`, if it has one, to the
+ inputs; the page shows what's under it. */
+void FilesDependTotal(struct Files *const files) {
+	const struct FilesTotal *const total = FilesGetTotal(files);
+	if(!total || !FilesIsDir(files)) return;
+	files->inputs = HashNumber(HashNumber(HashNumber(files->inputs,
+		total->bytes), total->files), total->newest);
 }
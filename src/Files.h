@@ -1,17 +1,46 @@
-extern const char *dir_current, *dir_parent;
+extern const char *dir_current, *dir_parent, *ignore_file;
 
 /** See <fn:Files>. */
 struct Files;
+struct File;
+struct Batch;
+struct Stats;
+
+/** The files under a directory, all the way down, or of a file: how many
+ bytes, how many, and the newest modification time. */
+struct FilesTotal { unsigned long bytes, files, newest; };
 
 /** Returns a boolean value on whether `files` should include `file`. */
-typedef int (*FilesFilter)(struct Files *const files, const char *file);
+typedef int (*FilesFilter)(struct Files *const files, const char *file,
+	void *const param);
 
-struct Files *Files(struct Files *const parent, const FilesFilter filter);
+struct Files *Files(const int root, struct Files *const parent,
+	const struct File *const dir, struct Batch *const batch,
+	struct Stats *const stats, const FilesFilter filter, void *const param);
 void Files_(struct Files *files);
+int FilesExpect(struct Files *const files, const char *const fn,
+	const FilesFilter filter, void *const param);
+void FilesDepend(struct Files *const files, const char *const fn);
+unsigned long FilesInputs(const struct Files *const files);
+int FilesFd(const struct Files *const files);
+int FilesHas(const struct Files *const files, const char *const fn);
+const char *FilesRead(struct Files *const files, const char *const fn,
+	size_t *const size);
+FILE *FilesOpen(struct Files *const files, const char *const fn,
+	const char *const mode);
 int FilesAdvance(struct Files *files);
+size_t FilesCount(const struct Files *f);
+void FilesSetPage(struct Files *f, const size_t first, const size_t size);
 int FilesIsRoot(const struct Files *f);
+int FilesRootFd(const struct Files *f);
 void FilesSetPath(struct Files *files);
 const char *FilesEnumPath(struct Files *const files);
+const struct File *FilesThis(const struct Files *const files);
 const char *FilesName(const struct Files *const files);
 int FilesSize(const struct Files *files);
 int FilesIsDir(const struct Files *files);
+const struct FilesTotal *FilesGetTotal(const struct Files *const files);
+void FilesSetTotal(struct Files *const files, const struct File *const dir,
+	const struct FilesTotal *const total);
+void FilesSum(const struct Files *const files, struct FilesTotal *const total);
+void FilesDependTotal(struct Files *const files);
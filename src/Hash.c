@@ -0,0 +1,50 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Hash
+ @author Neil
+
+ Fowler/Noll/Vo FNV-1a, used to fingerprint the inputs of a directory for
+ incremental rebuilds. Start with `hash` of zero; it is seeded with the offset
+ basis. The width is that of `unsigned long`, so it's 64-bit on LP64.
+
+ @std C89/90 */
+
+#include <stddef.h> /* size_t */
+#include <limits.h> /* ULONG_MAX */
+#include "Hash.h"
+
+#if ULONG_MAX > 4294967295UL
+static const unsigned long fnv_basis = 0xcbf29ce484222325UL;
+static const unsigned long fnv_prime = 0x100000001b3UL;
+#else
+static const unsigned long fnv_basis = 0x811c9dc5UL;
+static const unsigned long fnv_prime = 0x01000193UL;
+#endif
+
+/** @return `hash` continued with `size` bytes of `data`. */
+unsigned long Hash(unsigned long hash, const void *const data, size_t size) {
+	const unsigned char *a = data, *const z = a + size;
+	if(!hash) hash = fnv_basis;
+	while(a < z) hash = (hash ^ *a++) * fnv_prime;
+	return hash;
+}
+
+/** @return `hash` continued with `str`, including the terminating null, so
+ that concatenations are distinct. */
+unsigned long HashString(unsigned long hash, const char *const str) {
+	const unsigned char *a = (const unsigned char *)str;
+	if(!hash) hash = fnv_basis;
+	if(!a) return hash;
+	do hash = (hash ^ *a) * fnv_prime; while(*a++);
+	return hash;
+}
+
+/** @return `hash` continued with the number, `no`, independent of the
+ byte-order. */
+unsigned long HashNumber(unsigned long hash, unsigned long no) {
+	unsigned char b[sizeof no];
+	size_t i;
+	for(i = 0; i < sizeof no; i++) b[i] = (unsigned char)(no & 0xff), no >>= 8;
+	return Hash(hash, b, sizeof b);
+}
@@ -0,0 +1,3 @@
+unsigned long Hash(unsigned long hash, const void *const data, size_t size);
+unsigned long HashString(unsigned long hash, const char *const str);
+unsigned long HashNumber(unsigned long hash, unsigned long no);
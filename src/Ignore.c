@@ -0,0 +1,190 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Ignore
+ @author Neil
+
+ `Ignore` is the rules of the `.indexignore` of a directory, on top of the
+ ones of the directories above it, like `.gitignore`: a line is a glob, `*`,
+ `?`, and `[...]`, which don't go past a `/`, and `**`, which does; one that
+ starts with `!` lets back in what was left out before; one that ends in `/`
+ is only for directories; one that has a `/` anywhere but the end is from the
+ directory the file is in, and one that hasn't is a name anywhere under it.
+ Blank lines and lines that start with `#` are nothing. The rules that are
+ under come after, and, in the same file, the last one that matches is the
+ one that says.
+
+ They are read once, when a directory is listed, and copied into one block.
+ The ones that are just a name are compared without going through the glob.
+
+ @std C89/90 */
+
+#include <stdlib.h> /* malloc free */
+#include <string.h> /* strlen strchr strrchr strcmp memcpy */
+#include <assert.h>
+#include "Ignore.h"
+
+/* A line of the file. */
+struct Rule {
+	const char *glob; /* in the block */
+	int is_not, is_dir, is_path, is_literal;
+};
+
+/* public */
+struct Ignore {
+	const struct Ignore *parent; /* the rules that are above, or null */
+	size_t base; /* how much of a path is the directory of the file */
+	struct { struct Rule *data; size_t size; } rule;
+	char *block; /* the globs */
+};
+
+/** Destructor. */
+void Ignore_(struct Ignore **const ig_ptr) {
+	struct Ignore *ig;
+	if(!ig_ptr || !(ig = *ig_ptr)) return;
+	free(ig->rule.data);
+	free(ig->block);
+	free(ig);
+	*ig_ptr = 0;
+}
+
+/** Takes the rule of the line `[a, b)` into `r`, and it's glob to `block`.
+ @return One past the end of it in `block`, or null if it's nothing. */
+static char *rule(const char *a, const char *b, struct Rule *const r,
+	char *block) {
+	const char *c;
+	r->is_not = r->is_dir = r->is_path = 0, r->is_literal = 1;
+	if(b > a && b[-1] == '\r') b--;
+	/* trailing spaces, unless escaped */
+	while(b > a && b[-1] == ' ' && !(b - 1 > a && b[-2] == '\\')) b--;
+	if(a == b || *a == '#') return 0;
+	if(*a == '!') r->is_not = 1, a++;
+	else if(*a == '\\' && (a[1] == '!' || a[1] == '#')) a++;
+	if(b > a && b[-1] == '/') r->is_dir = 1, b--;
+	if(a == b) return 0;
+	for(c = a; c < b; c++) {
+		if(*c == '/') r->is_path = 1;
+		else if(*c == '*' || *c == '?' || *c == '[' || *c == '\\')
+			r->is_literal = 0;
+	}
+	if(*a == '/') a++;
+	if(a == b) return 0;
+	r->glob = block;
+	memcpy(block, a, (size_t)(b - a));
+	block += b - a;
+	*block++ = '\0';
+	return block;
+}
+
+/** Compiles the `size` bytes of `rules`, the `.indexignore` of the directory
+ that's `where` from the root, on top of `parent`, which must outlive it.
+ @return The rules, or null. @throws[malloc] */
+struct Ignore *Ignore(const struct Ignore *const parent,
+	const char *const where, const char *const rules, const size_t size) {
+	struct Ignore *ig;
+	const char *a, *b, *const z = rules + size;
+	char *block, *next;
+	size_t lines = 1;
+	assert(where && (rules || !size));
+	if(!(ig = malloc(sizeof *ig))) return 0;
+	ig->parent = parent;
+	ig->base = *where ? strlen(where) + 1 : 0;
+	ig->rule.data = 0, ig->rule.size = 0;
+	for(a = rules; a < z; a++) if(*a == '\n') lines++;
+	if(!(ig->rule.data = malloc(sizeof *ig->rule.data * lines))
+		|| !(ig->block = malloc(size + 1))) goto catch;
+	for(block = ig->block, a = rules; a < z; a = b + 1) {
+		for(b = a; b < z && *b != '\n'; b++);
+		if(!(next = rule(a, b, ig->rule.data + ig->rule.size, block)))
+			continue;
+		block = next, ig->rule.size++;
+	}
+	return ig;
+catch:
+	free(ig->rule.data);
+	free(ig);
+	return 0;
+}
+
+/** @return Whether `c` is in the class that starts at `*p_ptr`, after the
+ `[`; that's moved to the `]`, or null if there's no end. */
+static int class(const char **const p_ptr, const char c) {
+	const char *p = *p_ptr;
+	int is_not = 0, is = 0;
+	if(*p == '!' || *p == '^') is_not = 1, p++;
+	if(*p == ']') is = c == ']', p++; /* the first is literal */
+	for( ; *p && *p != ']'; p++) {
+		if(p[1] == '-' && p[2] && p[2] != ']') {
+			if((unsigned char)c >= (unsigned char)*p
+				&& (unsigned char)c <= (unsigned char)p[2]) is = 1;
+			p += 2;
+		} else if(*p == c) is = 1;
+	}
+	if(!*p) { *p_ptr = 0; return 0; }
+	*p_ptr = p;
+	return is != is_not;
+}
+
+/** @return Whether all of `s` is the glob `p`, which starts at `start`. */
+static int glob(const char *const start, const char *p, const char *s) {
+	for( ; *p; p++, s++) {
+		switch(*p) {
+		case '*':
+			/* a whole component; any number of directories */
+			if(p[1] == '*' && (p == start || p[-1] == '/')
+				&& (p[2] == '/' || !p[2])) {
+				if(!p[2]) return 1;
+				for(p += 3; ; s++) {
+					if(glob(start, p, s)) return 1;
+					if(!(s = strchr(s, '/'))) return 0;
+				}
+			}
+			while(p[1] == '*') p++;
+			for(p++; ; s++) {
+				if(glob(start, p, s)) return 1;
+				if(!*s || *s == '/') return 0;
+			}
+		case '?':
+			if(!*s || *s == '/') return 0;
+			break;
+		case '[': {
+			const char *q = p + 1;
+			int is;
+			if(!*s || *s == '/') return 0;
+			is = class(&q, *s);
+			if(!q) { if(*s != '[') return 0; break; } /* just a bracket */
+			if(!is) return 0;
+			p = q;
+			break;
+		}
+		case '\\':
+			if(p[1]) p++;
+			/* fall through */
+		default:
+			if(*p != *s) return 0;
+		}
+	}
+	return !*s;
+}
+
+/** @return Whether `path`, from the root, is left out by `ig`; it's a
+ directory if `is_dir`. A null `ig` leaves nothing out. */
+int IgnoreIs(const struct Ignore *ig, const char *const path,
+	const int is_dir) {
+	const char *name = strrchr(path, '/');
+	size_t i;
+	name = name ? name + 1 : path;
+	for( ; ig; ig = ig->parent) {
+		const char *const here = path + ig->base;
+		assert(ig->base <= strlen(path));
+		for(i = ig->rule.size; i; i--) {
+			const struct Rule *const r = ig->rule.data + i - 1;
+			const char *const s = r->is_path ? here : name;
+			if(r->is_dir && !is_dir) continue;
+			if(r->is_literal ? strcmp(r->glob, s)
+				: !glob(r->glob, r->glob, s)) continue;
+			return !r->is_not;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,7 @@
+struct Ignore;
+
+struct Ignore *Ignore(const struct Ignore *const parent,
+	const char *const where, const char *const rules, const size_t size);
+void Ignore_(struct Ignore **const ig_ptr);
+int IgnoreIs(const struct Ignore *ig, const char *const path,
+	const int is_dir);
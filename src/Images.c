@@ -0,0 +1,187 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Images
+ @author Neil
+
+ `Images` are the sizes of the images that have been asked about, so that the
+ icons can have a width and a height; it's only the header that's read, the
+ `IHDR` of a PNG, or the start of frame of a JPEG, and nothing is decoded. They
+ are kept by device, inode, modification time, and size, so an icon that's on
+ every page, like `dir.png`, is read once, and one that's changed is read
+ again. It can be shared by threads.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>    /* malloc calloc free */
+#include <string.h>    /* memcmp memset */
+#include <errno.h>
+#include <unistd.h>    /* pread close */
+#include <fcntl.h>     /* openat */
+#include <sys/types.h>
+#include <sys/stat.h>  /* fstatat */
+#include <pthread.h>
+#include <assert.h>
+#include "Hash.h"
+#include "Images.h"
+
+/* constants */
+static const unsigned char png[8]
+	= { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+static const size_t images_min = 64;
+static const size_t images_max = 4096; /* then it starts again */
+
+/* An image that was read; the size is zero if it's not one we know. */
+struct Image {
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+	off_t size;
+	unsigned width, height;
+	int is;
+};
+
+/* public */
+struct Images {
+	pthread_mutex_t lock;
+	struct { struct Image *data; size_t size, capacity; } table; /* hash */
+};
+
+/** Destructor. */
+void Images_(struct Images **const im_ptr) {
+	struct Images *im;
+	if(!im_ptr || !(im = *im_ptr)) return;
+	pthread_mutex_destroy(&im->lock);
+	free(im->table.data);
+	free(im);
+	*im_ptr = 0;
+}
+
+/** @return An empty cache of sizes of images, or null.
+ @throws[malloc, pthread_mutex_init] */
+struct Images *Images(void) {
+	struct Images *im;
+	int e;
+	if(!(im = malloc(sizeof *im))) return 0;
+	im->table.size = 0, im->table.capacity = images_min;
+	if(!(im->table.data = calloc(images_min, sizeof *im->table.data)))
+		{ free(im); return 0; }
+	if((e = pthread_mutex_init(&im->lock, 0)))
+		{ free(im->table.data); free(im); errno = e; return 0; }
+	return im;
+}
+
+/** @return The place in `im` where `st` is, or would go. */
+static struct Image *slot(const struct Images *const im,
+	const struct stat *const st) {
+	const size_t mask = im->table.capacity - 1;
+	size_t s = HashNumber(HashNumber(0, (unsigned long)st->st_dev),
+		(unsigned long)st->st_ino) & mask;
+	struct Image *i;
+	while((i = im->table.data + s)->is && (i->dev != st->st_dev
+		|| i->ino != st->st_ino)) s = (s + 1) & mask;
+	return i;
+}
+
+/** Puts `image` in `im`; it grows when it's half-full, or, at `images_max`,
+ starts again. Must have the lock. */
+static void put(struct Images *const im, const struct Image *const image) {
+	struct stat st;
+	struct Image *i;
+	if((im->table.size + 1) << 1 > im->table.capacity) {
+		struct Image *const old = im->table.data, *o;
+		const size_t c = im->table.capacity;
+		if(c >= images_max || !(im->table.data = calloc(c << 1, sizeof *old))) {
+			im->table.data = old;
+			memset(old, 0, sizeof *old * c), im->table.size = 0;
+		} else {
+			im->table.capacity = c << 1, im->table.size = 0;
+			for(o = old; o < old + c; o++) if(o->is) {
+				st.st_dev = o->dev, st.st_ino = o->ino;
+				*slot(im, &st) = *o, im->table.size++;
+			}
+			free(old);
+		}
+	}
+	st.st_dev = image->dev, st.st_ino = image->ino;
+	if(!(i = slot(im, &st))->is) im->table.size++;
+	*i = *image;
+}
+
+/** @return The big-endian number at `b` with `n` bytes. */
+static unsigned long big(const unsigned char *const b, const unsigned n) {
+	unsigned long x = 0;
+	unsigned i;
+	for(i = 0; i < n; i++) x = x << 8 | b[i];
+	return x;
+}
+
+/** Reads the width and height from the header of the image open in `fd`,
+ which is a PNG or a JPEG, into `image`. */
+static void header(const int fd, struct Image *const image) {
+	unsigned char b[24];
+	off_t at;
+	ssize_t r;
+	image->width = image->height = 0;
+	if((r = pread(fd, b, sizeof b, 0)) < 2) return;
+	/* the signature, and then `IHDR` is always the first chunk */
+	if(r == sizeof b && !memcmp(b, png, sizeof png)
+		&& !memcmp(b + 12, "IHDR", 4)) {
+		image->width = (unsigned)big(b + 16, 4);
+		image->height = (unsigned)big(b + 20, 4);
+		return;
+	}
+	/* start of image, and then segments up to the start of frame */
+	if(b[0] != 0xff || b[1] != 0xd8) return;
+	for(at = 2; pread(fd, b, 9, at) == 9 && b[0] == 0xff; ) {
+		const unsigned marker = b[1];
+		if(marker == 0xff) { at++; continue; } /* fill */
+		if(marker == 0x01 || marker >= 0xd0 && marker <= 0xd7)
+			{ at += 2; continue; } /* no length */
+		if(marker >= 0xc0 && marker <= 0xcf && marker != 0xc4
+			&& marker != 0xc8 && marker != 0xcc) {
+			image->height = (unsigned)big(b + 5, 2);
+			image->width = (unsigned)big(b + 7, 2);
+			return;
+		}
+		if(marker == 0xd9 || marker == 0xda || big(b + 2, 2) < 2) return;
+		at += 2 + (off_t)big(b + 2, 2);
+	}
+}
+
+/** Gets the `width` and `height` of the image `fn` in `dirfd`; it's only
+ read if it's not in `im`, which can be null to not keep it.
+ @return Success, or it's not a PNG or JPEG that says.
+ @throws[fstatat, openat, EDOM] */
+int ImagesSize(struct Images *const im, const int dirfd, const char *const fn,
+	unsigned *const width, unsigned *const height) {
+	struct Image image, *i;
+	struct stat st;
+	int fd, is = 0;
+	assert(fn && width && height);
+	if(fstatat(dirfd, fn, &st, 0)) return 0;
+	if(im) {
+		pthread_mutex_lock(&im->lock);
+		if((i = slot(im, &st))->is && i->mtime == st.st_mtime
+			&& i->size == st.st_size) image = *i, is = 1;
+		pthread_mutex_unlock(&im->lock);
+	}
+	if(!is) {
+		/* two threads might read the same one; it's the same either way */
+		if((fd = openat(dirfd, fn, O_RDONLY)) == -1) return 0;
+		image.dev = st.st_dev, image.ino = st.st_ino;
+		image.mtime = st.st_mtime, image.size = st.st_size;
+		image.is = 1;
+		header(fd, &image);
+		close(fd);
+		if(im) {
+			pthread_mutex_lock(&im->lock);
+			put(im, &image);
+			pthread_mutex_unlock(&im->lock);
+		}
+	}
+	if(!image.width || !image.height) { errno = EDOM; return 0; }
+	*width = image.width, *height = image.height;
+	return 1;
+}
@@ -0,0 +1,6 @@
+struct Images;
+
+struct Images *Images(void);
+void Images_(struct Images **const im_ptr);
+int ImagesSize(struct Images *const im, const int dirfd, const char *const fn,
+	unsigned *const width, unsigned *const height);
@@ -1,228 +1,893 @@
 /** @license 2000, 2012 Neil Edelman, distributed under the terms of the
  [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
 
- @subtitle make-index
+ @subtitle MakeIndex
  @author Neil
 
  `MakeIndex` is the main part of `make-index`, a content management system that
  generates static content on all the directories based on templates rooted at
- the working directory.
+ a directory. The templates are the files at the root, `.<name>.<ext>`, that
+ make `<name>.<ext>`: `.index.html` is the index, which is split over pages;
+ any other is also in every directory, unless it's in sections, `~`, then it's
+ one at the root, like `.sitemap.xml`, where the body is every directory, or,
+ if it has the news in it, like `.newsfeed.rss`, every news item. They are all
+ rendered from the same reading of the tree.
 
- There should be an `example` directory that has a bunch of files in it. Run
- `../bin/make-index` in the example directory; it should make a webpage out of
- the directory structure and the templates.
+ It's a context: the templates are read once, when it's made, and
+ it owns the outputs and everything it renders with, and is relative to it's
+ root, not the working directory, so there can be more than one in a
+ programme. It can build the whole tree, <fn:MakeIndexBuild>, render one
+ directory to memory, <fn:MakeIndexRender>, stay, <fn:MakeIndexWatch>, or
+ serve pages as they are asked for, <fn:MakeIndexServe>; or write the
+ templates as C, <fn:MakeIndexCompile>. One call at a time on the same
+ context. `main.c` is the command-line.
 
- @std POSIX.1
+ It's `libmakeindex` without `main.c`.
+
+ @std POSIX.1-2008
  @fixme Parse `.d` files.
  @fixme Encoding is an issue; especially the newsfeed, which requires 7-bit.
  @fixme It's not robust; _eg_ `@(files){@(files){Don't do this.}}`. */
 
-#include <stdlib.h>		/* malloc free fgets */
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>		/* malloc free */
 #include <stdio.h>		/* fprintf FILE */
 #include <string.h>		/* strcmp */
-#include <unistd.h>		/* chdir (POSIX, not ANSI) */
-#include <sys/types.h>	/* mode_t (umask) */
-#include <sys/stat.h>	/* umask */
+#include <unistd.h>		/* faccessat (POSIX, not ANSI) */
+#include <fcntl.h>		/* openat */
+#include <dirent.h>		/* fdopendir readdir closedir */
+#include <ctype.h>		/* isalnum */
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>	/* fstat */
 #include <errno.h>		/* EDOM */
+#include <signal.h>		/* sig_atomic_t */
 #include <assert.h>
 #include "Files.h"
 #include "Widget.h"
 #include "Parser.h"
+#include "Hash.h"
+#include "Snapshot.h"
+#include "Pool.h"
+#include "Text.h"
+#include "Batch.h"
+#include "Feed.h"
+#include "Watch.h"
+#include "Stats.h"
+#include "Server.h"
+#include "Images.h"
+#include "Writer.h"
+#include "MakeIndex.h"
 
 /* constants */
 static const size_t granularity      = 1024;
-static const char *html_index        = "index.html";
-static const char *xml_sitemap       = "sitemap.xml";
-static const char *rss_newsfeed      = "newsfeed.rss";
-static const char *template_index    = ".index.html";
-static const char *template_sitemap  = ".sitemap.xml";
-static const char *template_newsfeed = ".newsfeed.rss";
+const char *html_index               = "index.html"; /* also in main.c */
+const char *xml_sitemap              = "sitemap.xml";
+const char *rss_newsfeed             = "newsfeed.rss";
+const char *template_index           = ".index.html";
+const char *template_sitemap         = ".sitemap.xml";
+const char *template_newsfeed        = ".newsfeed.rss";
+const char *snapshot_file            = ".make-index";
+static const size_t stream_flush     = 65536;
+static const unsigned batch_depth    = 64;
+const size_t news_max                = 20;
+static const int watch_debounce      = 200; /* milliseconds */
+static const size_t stats_slowest    = 10;
+static const size_t cache_max        = 256;
+static const size_t template_max     = 64; /* the name, and `name` below */
 /* in Files.c */
 extern const char *dir_current;
 extern const char *dir_parent;
 /* in Widget.c */
-extern const char *dot_news;
+extern const char *dot_desc, *dot_news, *dot_link;
+
+/* The sections of the aggregate templates. */
+enum { head, body, tail };
+
+/* Where a directory is rendered to; there's one for every thread, and the
+ buffers are reused. In serial, the aggregates are rendered to the streams;
+ in parallel, or watching, every directory renders them one after the other
+ to `site`, where the one of stream `i` ends at `end[i]`, it's copied, and
+ those are put together in order. */
+struct job {
+	struct MakeIndex *mi;
+	struct Text *page, *site;
+	size_t *end;
+	struct Text *gz; /* with `gzip` */
+	struct Batch *batch; /* with `uring`, if it's available */
+	struct Writer *writer; /* when building, the pages are written there */
+	struct node *node; /* when watching, what it's rendering */
+	struct Stats *stats; /* with `stats` */
+	int is_news; /* whether the news it finds is kept */
+	struct Widget widget;
+};
+
+/* Bytes of the aggregates that a directory rendered; the one of stream `i`
+ ends at `end[i]` in `buf`, which is in the same block, after it. */
+struct fragment { size_t *end; char *buf; };
+
+/* A directory in parallel. These form a tree in the order of the serial run,
+ so that the output is the same; a task is freed when it has been output, it's
+ index has been written, and all it's children have been freed. The index is
+ written by whichever thread brings `pending` to zero, the last of it's own
+ and it's children's subtrees. */
+struct task {
+	struct MakeIndex *mi;
+	struct task *parent, *child, *next;
+	struct Files *files;
+	const struct File *dir;
+	size_t refs, pending;
+	int done;
+	double elapsed;
+	struct fragment site;
+};
+
+/* When watching, a directory that stays between runs: where it is, what it
+ put in the aggregates, it's news, and it's total. It's `dirty` if it has to be
+ read again, and `below` if something under it does, which changes the total,
+ so it's index is written again. */
+struct node {
+	struct node *parent, *child, *next;
+	char *path; /* from the root, with a trailing slash */
+	const char *name; /* in `path` */
+	unsigned long hash; /* of `path`, as in the snapshot */
+	int wd, dirty, below;
+	struct FilesTotal total;
+	struct fragment site;
+	struct { struct FeedItem *data; size_t size, capacity; } news;
+};
+
+/* When watching, the tree of directories, and how to find them by watch. */
+struct watcher {
+	struct MakeIndex *mi;
+	struct Watch *watch;
+	struct node *root;
+	struct { struct node **data; size_t size; } wds;
+	struct job job;
+};
+
+/* A listing that is kept for <fn:MakeIndexRender>; it's `files` of `path`,
+ as it was when that was `dev`, `ino`, `mtime`. The ones under it point into
+ it, so it's only let go when it has no `children`. */
+struct listing {
+	struct listing *parent;
+	struct listing *prev, *next; /* the most recently used first */
+	char *path; /* from the root, with a trailing slash */
+	struct Files *files;
+	dev_t dev;
+	ino_t ino;
+	struct timespec mtime;
+	size_t children;
+};
+
+/* A template at the root, `file`, that makes `name`, and, with `gzip`,
+ `gz`; they are all in the block of `file`. */
+struct template {
+	char *file;
+	const char *name, *gz;
+	char *string;
+	struct Parser *parser;
+};
 
-/* Error reporting. */
-static const char *why;
+/* An aggregate output; it's written to a temporary file as it goes, and is
+ replaced at the end if everything went well. The body is every directory,
+ or, if `is_news`, every news item. */
+struct stream {
+	struct template t;
+	struct Text *text;
+	int fd, ok, is_news;
+};
 
-/* Singleton. */
-static struct recursor {
+/* public */
+struct MakeIndex {
+	struct MakeIndexOptions option;
+	char *root; /* as it was given */
+	int fd; /* the root, which everything is relative to */
+	int out; /* where the outputs go; `fd`, unless there's `output` */
+	struct { char *name; dev_t dev; ino_t ino; } skip; /* `output` */
+	const char *why; /* error reporting */
+	char now[24]; /* the time of the build */
 	struct { char *string; struct Parser *parser; } index;
-	struct { char *string; struct Parser *parser; FILE *fp; } sitemap, newsfeed;
-} *r;
-
-static void usage(void) {
-	static const char *programme = "make-index";
-	fprintf(stderr,
-		"%s is a content management system that generates static\n"
-		"content on all the directories rooted at the current directory.\n\n"
-		"If you have these files accessible in the current directory, then,\n"
-		"<%s>\tcreates <%s> in all accessible subdirectories,\n"
-		"<%s>\tcreates <%s> from all the .news encountered,\n"
-		"<%s>\tcreates <%s> of all accessible subdirectories.\n\n",
-		programme,
-		template_index, html_index,
-		template_newsfeed, rss_newsfeed,
-		template_sitemap, xml_sitemap);
-	fprintf(stderr, "Of special significance:\n"
-		" <file>.d is a description of <file>;\n"
-		"  if this description is empty or has a leading blank line,\n"
-		"  it skips over this file;\n"
-		" index.d is a description of the directory;\n"
-		" content.d is an in-depth description of the directory;\n"
-		" <file>.d.jpg is an (icon) image that will go with the description;\n"
-		" <news>.news as a newsworthy item; the format of this file is\n"
-		"  ISO 8601 date (YYYY-MM-DD,) next line title;\n"
-		" <link>.link as a link with the href in the file.\n\n");
-	fprintf(stderr,
-		"2000, 2012 Neil Edelman, distributed under the terms of the\n"
-		"GNU General Public License 3.\n\n");
-}
-
-/** Reads the entire rest of `fp` and closes it.
+	struct { struct template *data; size_t size; } each; /* directory */
+	struct { struct stream *data; size_t size; } stream; /* aggregate */
+	struct Feed *feed; /* the news, rendered at the end */
+	struct Snapshot *snapshot;
+	struct Stats *stats; /* with `stats`, the total */
+	struct Images *images; /* the sizes of the icons */
+	struct Writer *writer; /* while building */
+	struct job *jobs; /* one for every worker in parallel */
+	struct job render; /* for <fn:MakeIndexRender>, made the first time */
+	struct { struct listing *head, *tail; size_t size; } cache; /* `render` */
+	pthread_mutex_t lock; /* protects everything shared by the tasks */
+	int is_lock;
+	struct task *next; /* to output */
+	int failed, publish;
+	int unwritten; /* why the first page wasn't written, or zero */
+	struct { int uring, watch; } warned; /* said once */
+};
+
+/** Reads the entire rest of `fd` and closes it. It's sized from `fstat`, so
+ that it's usually one `read`, and grows by doubling if it's longer.
  @return A dynamically allocated string. One must `free` the memory.
- @throws[realloc, fread, fclose, EILSEQ] */
-static char *read_until_close(FILE *fp) {
+ @throws[fstat, malloc, realloc, read, close] */
+static char *read_until_close(const struct MakeIndex *const mi, const int fd) {
+	struct stat st;
 	char *buf = 0, *newBuf;
-	size_t bufPos = 0, bufSize = 0, rd;
-	assert(fp);
-	do {
-		if(!(newBuf = realloc(buf, bufSize += granularity))) goto catch;
-		buf = newBuf;
-		bufPos += (rd = fread(buf + bufPos, 1, granularity, fp));
-	} while(rd == granularity);
+	size_t bufPos = 0, bufSize = granularity;
+	ssize_t rd;
+	assert(mi && fd != -1);
+	if(fstat(fd, &st)) goto catch;
+	/* room for the null, and to see the end without growing */
+	if(st.st_size > 0) bufSize = (size_t)st.st_size + 2;
+	if(!(buf = malloc(bufSize))) goto catch;
+	for( ; ; ) {
+		if(bufPos + 1 >= bufSize) {
+			if(!(newBuf = realloc(buf, bufSize <<= 1))) goto catch;
+			buf = newBuf;
+		}
+		if((rd = read(fd, buf + bufPos, bufSize - 1 - bufPos)) == -1)
+			{ if(errno == EINTR) continue; goto catch; }
+		if(!rd) break;
+		bufPos += (size_t)rd;
+	}
 	buf[bufPos] = '\0';
-	if(ferror(fp)) { if(!errno) errno = EILSEQ; goto catch; }
-	fprintf(stderr, "Allotted %lu bytes to read %lu bytes.\n",
+	if(mi->option.verbose) fprintf(stderr,
+		"Allotted %lu bytes to read %lu bytes.\n",
 		(unsigned long)bufSize, (unsigned long)bufPos);
 	goto finally;
 catch:
 	free(buf), buf = 0;
 finally:
-	if(fp && fclose(fp) == EOF) { fp = 0; goto catch; };
+	if(close(fd) && buf) free(buf), buf = 0;
 	return buf;
 }
 
-/** Destructor. */
-static void recursor_(void) {
-	if(!r) return;
-	if(r->sitemap.parser && r->sitemap.fp)  {
-		ParserParse(r->sitemap.parser, r->sitemap.fp, 0, -1);
-		ParserParse(r->sitemap.parser, r->sitemap.fp, 0, 0);
-	}
-	if(r->sitemap.fp && fclose(r->sitemap.fp)) perror(xml_sitemap);
-	if(r->newsfeed.parser && r->newsfeed.fp) {
-		ParserParse(r->newsfeed.parser, r->newsfeed.fp, 0, -1);
-		ParserParse(r->newsfeed.parser, r->newsfeed.fp, 0, 0);
-	}
-	if(r->newsfeed.fp && fclose(r->newsfeed.fp)) perror(rss_newsfeed);
-	Parser_(&r->index.parser);
-	free(r->index.string);
-	Parser_(&r->sitemap.parser);
-	free(r->sitemap.string);
-	Parser_(&r->newsfeed.parser);
-	free(r->newsfeed.string);
-	free(r);
-	r = 0;
-}
-
-/** Constructor of singleton. */
-static struct recursor *recursor(void) {
-	FILE *fp = 0;
-	assert(!r);
-	if(!(r = malloc(sizeof *r))) { why = "recursor"; goto catch; };
-	r->index.string = 0;
-	r->index.parser = 0;
-	r->sitemap.string = 0;
-	r->sitemap.parser = 0;
-	r->sitemap.fp = 0;
-	r->newsfeed.string = 0;
-	r->newsfeed.parser = 0;
-	r->newsfeed.fp = 0;
-
-	/* read index template -- index is opened multiple times */
-	if(!(fp = fopen(template_index, "r"))) { /* This is not an error. */
-		perror(template_index);
-		fprintf(stderr, "MakeIndex: to make an index, create the file <%s>.\n",
-			template_index);
-	} else if(!(r->index.string = read_until_close(fp))
-		|| !(r->index.parser = Parser(r->index.string)))
-		{ why = template_index; goto catch; }
-
-	/* read sitemap template */
-	if(!(fp = fopen(template_sitemap, "r"))) { /* This is not an error. */
-		perror(template_sitemap);
-		fprintf(stderr, "MakeIndex: to make a sitemap, create the file <%s>.\n",
-			template_sitemap);
-	} else {
-		if(!(r->sitemap.string = read_until_close(fp))
-			|| !(r->sitemap.parser = Parser(r->sitemap.string)))
-			{ why = template_sitemap; goto catch; }
-		if(!(r->sitemap.fp = fopen(xml_sitemap,  "w")))
-			{ why = xml_sitemap; goto catch; }
-	}
-
-	/* read newsfeed template */
-	if(!(fp = fopen(template_newsfeed, "r"))) { /* This is not an error. */
-		perror(template_newsfeed);
-		fprintf(stderr, "MakeIndex: to make a newsfeed, create the file <%s>.\n",
-			template_newsfeed);
+/** Frees the template `t`. */
+static void template_(struct template *const t) {
+	Parser_(&t->parser);
+	free(t->string), t->string = 0;
+	free(t->file), t->file = 0;
+}
+
+/** @return Whether `fn` is a template, `.<name>.<ext>`, of letters, digits,
+ `-`, and `_`, that's not a description, news, a link, or what an editor
+ leaves, (vim swaps, `.<name>.sw<x>`.) It's also a regular file, see
+ <fn:discover>. */
+static int is_template(const char *const fn) {
+	const char *ext, *c;
+	if(*fn != '.' || strlen(fn) >= template_max
+		|| !(ext = strchr(fn + 1, '.')) || ext == fn + 1 || !ext[1]) return 0;
+	for(c = fn + 1; *c; c++) if(c != ext && *c != '-' && *c != '_'
+		&& !isalnum((unsigned char)*c)) return 0;
+	if(!strncmp(ext, ".sw", 3) && ext[3] && !ext[4]) return 0;
+	return strcmp(ext, dot_desc) && strcmp(ext, dot_news)
+		&& strcmp(ext, dot_link);
+}
+
+/** @return Whether the body of `p` has the news in it. */
+static int is_news(const struct Parser *const p) {
+	return ParserUses(p, body, &WidgetDate) || ParserUses(p, body, &WidgetNews)
+		|| ParserUses(p, body, &WidgetNewsname)
+		|| ParserUses(p, body, &WidgetTitle);
+}
+
+/** Reads the template `file` at the root of `mi`, and puts it with the
+ others, by what it is. @return Success. @throws[openat, malloc, read] */
+static int template(struct MakeIndex *const mi, const char *const file) {
+	struct template t;
+	const size_t len = strlen(file);
+	int fd;
+	t.file = t.string = 0, t.parser = 0;
+	if((fd = openat(mi->fd, file, O_RDONLY)) == -1
+		|| !(t.string = read_until_close(mi, fd))
+		|| !(t.parser = Parser(t.string))) goto catch;
+	if(!strcmp(file, template_index)) {
+		mi->index.string = t.string, mi->index.parser = t.parser;
+		return 1;
+	}
+	/* `.name.ext\0name.ext.gz\0` */
+	if(!(t.file = malloc(len + len + strlen(dot_gz) + 1))) goto catch;
+	strcpy(t.file, file);
+	t.name = t.file + 1;
+	strcpy(t.file + len + 1, t.name), strcat(t.file + len + 1, dot_gz);
+	t.gz = t.file + len + 1;
+	if(ParserSections(t.parser) > 1) {
+		struct stream *const s = mi->stream.data + mi->stream.size;
+		if(!(s->text = Text())) goto catch;
+		s->t = t, s->fd = -1, s->ok = 1, s->is_news = is_news(t.parser);
+		mi->stream.size++;
 	} else {
-		if(!(r->newsfeed.string = read_until_close(fp))
-			|| !(r->newsfeed.parser = Parser(r->newsfeed.string)))
-			{ why = template_newsfeed; goto catch; }
-		if(!(r->newsfeed.fp = fopen(rss_newsfeed, "w")))
-			{ why = rss_newsfeed; goto catch; }
+		mi->each.data[mi->each.size++] = t;
+	}
+	if(mi->option.verbose) fprintf(stderr, "Template <%s> makes <%s>%s.\n",
+		file, t.name, ParserSections(t.parser) < 2 ? " in every directory"
+		: mi->stream.data[mi->stream.size - 1].is_news ? " of the news"
+		: " of every directory");
+	return 1;
+catch:
+	template_(&t);
+	return 0;
+}
+
+/** @return Sorts strings. @implements qsort */
+static int compare(const void *a, const void *b) {
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/** Reads the templates at the root of `mi`, the files `.<name>.<ext>`, in
+ order. @return Success. @throws[openat, fdopendir, readdir, malloc, read] */
+static int discover(struct MakeIndex *const mi) {
+	struct { char **data; size_t size, capacity; } file = { 0, 0, 0 };
+	struct dirent *de;
+	struct stat st;
+	DIR *d = 0;
+	size_t i;
+	int fd, success = 0;
+	mi->why = dir_current;
+	if((fd = openat(mi->fd, dir_current, O_RDONLY | O_DIRECTORY)) == -1)
+		goto finally;
+	if(!(d = fdopendir(fd))) { close(fd); goto finally; }
+	for(errno = 0; (de = readdir(d)); errno = 0) {
+		/* a directory or a device with the name is not ours */
+		if(!is_template(de->d_name) || fstatat(fd, de->d_name, &st, 0)
+			|| !S_ISREG(st.st_mode)) continue;
+		if(file.size >= file.capacity) {
+			const size_t c = file.capacity ? file.capacity << 1 : 8;
+			char **data;
+			if(!(data = realloc(file.data, sizeof *data * c))) goto finally;
+			file.data = data, file.capacity = c;
+		}
+		if(!(file.data[file.size] = malloc(strlen(de->d_name) + 1)))
+			goto finally;
+		strcpy(file.data[file.size++], de->d_name);
+	}
+	if(errno) goto finally;
+	if(file.size) {
+		/* readdir is in any order */
+		qsort(file.data, file.size, sizeof *file.data, &compare);
+		if(!(mi->each.data = malloc(sizeof *mi->each.data * file.size))
+			|| !(mi->stream.data = malloc(sizeof *mi->stream.data
+			* file.size))) goto finally;
 	}
+	for(i = 0; i < file.size; i++) if(!template(mi, file.data[i])) {
+		const int e = errno;
+		fprintf(stderr, "MakeIndex: in the template <%s>.\n", file.data[i]);
+		errno = e, mi->why = "template";
+		goto finally;
+	}
+	success = 1;
+finally:
+	if(d) closedir(d);
+	for(i = 0; i < file.size; i++) free(file.data[i]);
+	free(file.data);
+	return success;
+}
+
+/** Starts writing `s` with the head. @return Success. */
+static int stream_begin(struct MakeIndex *const mi, struct stream *const s) {
+	struct Widget w;
+	assert(s->fd == -1);
+	TextClear(s->text);
+	s->ok = 1;
+	if((s->fd = TextBegin(mi->out, s->t.name)) == -1)
+		{ mi->why = s->t.name; return 0; }
+	/* the `Files` is null, so @files{}, @pwd{}, etc are undefined */
+	WidgetClear(&w, mi->now, mi->images);
+	ParserParse(s->t.parser, head, s->text, 0, &w);
+	return 1;
+}
+
+/** Writes what `s` has so far if there's enough of it, or if `all`. */
+static void stream_drain(struct MakeIndex *const mi, struct stream *const s,
+	const int all) {
+	const size_t size = TextSize(s->text);
+	double t;
+	if(s->fd == -1 || !s->ok || !all && size < stream_flush) return;
+	t = StatsStart(mi->stats);
+	if(!TextFlush(s->text, s->fd)) perror(s->t.name), s->ok = 0;
+	StatsStop(mi->stats, StatsWrite, t, 0);
+	StatsBytes(mi->stats, (unsigned long)size);
+}
+
+/** With `gzip`, compresses what was written to `s`. */
+static void stream_gzip(struct MakeIndex *const mi, struct stream *const s) {
+	struct Text *gz = 0;
+	TextClear(s->text);
+	if(!TextRead(s->text, mi->out, s->t.name) || !(gz = Text())
+		|| !TextGzip(s->text, gz) || !TextPublish(gz, mi->out, s->t.gz, 0))
+		perror(s->t.gz);
+	Text_(&gz);
+}
+
+/** Renders the tail and replaces the file if `mi->publish`. */
+static void stream_end(struct MakeIndex *const mi, struct stream *const s) {
+	struct Widget w;
+	int written = 0;
+	const int commit = s->ok && mi->publish;
+	double t;
+	if(s->fd == -1) return;
+	WidgetClear(&w, mi->now, mi->images);
+	ParserParse(s->t.parser, tail, s->text, 0, &w);
+	stream_drain(mi, s, 1);
+	t = StatsStart(mi->stats);
+	if(!TextEnd(mi->out, s->t.name, s->fd, commit, &written)) {
+		if(commit) perror(s->t.name);
+	} else if(mi->option.gzip
+		&& (written || faccessat(mi->out, s->t.gz, F_OK, 0))) {
+		stream_gzip(mi, s);
+	}
+	StatsStop(mi->stats, StatsWrite, t, (unsigned long)!!written);
+	s->fd = -1;
+}
+
+/** Ends `s` and frees it. */
+static void stream_close(struct MakeIndex *const mi, struct stream *const s) {
+	stream_end(mi, s);
+	Text_(&s->text);
+	template_(&s->t);
+}
+
+/** @return Whether any of the streams of `mi` is of the news. */
+static int has_news(const struct MakeIndex *const mi) {
+	size_t i;
+	for(i = 0; i < mi->stream.size; i++)
+		if(mi->stream.data[i].is_news) return 1;
+	return 0;
+}
+
+/** Starts all the streams of `mi` that aren't. @return Success. */
+static int streams_begin(struct MakeIndex *const mi) {
+	size_t i;
+	for(i = 0; i < mi->stream.size; i++) if(mi->stream.data[i].fd == -1
+		&& !stream_begin(mi, mi->stream.data + i)) return 0;
+	return 1;
+}
+
+/** Writes what all the streams of `mi` have so far if there's enough. */
+static void streams_drain(struct MakeIndex *const mi) {
+	size_t i;
+	for(i = 0; i < mi->stream.size; i++)
+		stream_drain(mi, mi->stream.data + i, 0);
+}
+
+/** Renders the news in `mi->feed`, newest first, into the streams of the
+ news; each body is only read now, and only for the ones that made it. */
+static void feed(struct MakeIndex *const mi) {
+	const struct FeedItem *item;
+	struct Text *content;
+	struct Widget w, x;
+	char *fn;
+	size_t i, j, n;
+	double t;
+	if(!mi->feed) return;
+	if(!(content = Text())) {
+		perror("news");
+		for(j = 0; j < mi->stream.size; j++)
+			if(mi->stream.data[j].is_news) mi->stream.data[j].ok = 0;
+		return;
+	}
+	for(n = FeedSort(mi->feed), i = 0; i < n; i++) {
+		item = FeedGet(mi->feed, i);
+		WidgetClear(&w, mi->now, mi->images);
+		w.news.year = item->year, w.news.month = item->month,
+			w.news.day = item->day;
+		strcpy(w.news.title, item->title);
+		strcpy(w.news.name, item->name);
+		w.news.dir = item->dir;
+		TextClear(content);
+		if(!(fn = malloc(strlen(item->dir) + strlen(item->name) + 1))) {
+			perror(item->name); continue;
+		}
+		strcpy(fn, item->dir);
+		strcat(fn, item->name);
+		if(!TextRead(content, mi->fd, fn)) perror(fn);
+		free(fn);
+		w.news.body = TextData(content, &w.news.size);
+		if(!w.news.body) w.news.body = "";
+		for(j = 0; j < mi->stream.size; j++) {
+			struct stream *const s = mi->stream.data + j;
+			if(!s->is_news || s->fd == -1) continue;
+			x = w;
+			t = StatsStart(mi->stats);
+			ParserParse(s->t.parser, body, s->text, 0, &x);
+			StatsStop(mi->stats, StatsRender, t, 1);
+			stream_drain(mi, s, 0);
+		}
+	}
+	Text_(&content);
+}
+
+/** Ends all the streams of `mi`, with the news first if they're published. */
+static void streams_end(struct MakeIndex *const mi) {
+	size_t i;
+	if(mi->publish) feed(mi);
+	for(i = 0; i < mi->stream.size; i++) stream_end(mi, mi->stream.data + i);
+}
+
+/** Lets go of `l` in `mi`, which has no children left. */
+static void listing_(struct MakeIndex *const mi, struct listing *const l) {
+	assert(mi && l && !l->children);
+	if(l->prev) l->prev->next = l->next; else mi->cache.head = l->next;
+	if(l->next) l->next->prev = l->prev; else mi->cache.tail = l->prev;
+	if(l->parent) l->parent->children--;
+	mi->cache.size--;
+	Files_(l->files);
+	free(l->path);
+	free(l);
+}
+
+/** Lets go of `l` and everything under it that's kept in `mi`, or, if it's
+ null, everything. */
+static void forget(struct MakeIndex *const mi, struct listing *const l) {
+	struct listing *x, *next;
+	const size_t len = l ? strlen(l->path) : 0;
+	/* they all go, so in any order */
+	for(x = mi->cache.head; x; x = x->next)
+		if(!l || x != l && !strncmp(x->path, l->path, len))
+			x->parent = 0, x->children = 0;
+	for(x = mi->cache.head; x; x = next) {
+		next = x->next;
+		if(!l || x != l && !strncmp(x->path, l->path, len)) listing_(mi, x);
+	}
+	if(l) l->children = 0, listing_(mi, l);
+}
+
+/** Destructor; anything that was being written is thrown away. */
+void MakeIndex_(struct MakeIndex **const mi_ptr) {
+	struct MakeIndex *mi;
+	size_t i;
+	if(!mi_ptr || !(mi = *mi_ptr)) return;
+	mi->publish = 0;
+	for(i = 0; i < mi->stream.size; i++) stream_close(mi, mi->stream.data + i);
+	free(mi->stream.data);
+	for(i = 0; i < mi->each.size; i++) template_(mi->each.data + i);
+	free(mi->each.data);
+	forget(mi, 0);
+	Text_(&mi->render.page);
+	Batch_(&mi->render.batch);
+	Stats_(&mi->stats);
+	Images_(&mi->images);
+	Feed_(&mi->feed);
+	Snapshot_(&mi->snapshot);
+	if(mi->is_lock) pthread_mutex_destroy(&mi->lock);
+	Parser_(&mi->index.parser);
+	free(mi->index.string);
+	if(mi->out != -1 && mi->out != mi->fd && close(mi->out))
+		perror(mi->option.output);
+	if(mi->fd != -1 && close(mi->fd)) perror(mi->root);
+	free(mi->skip.name);
+	free(mi);
+	*mi_ptr = 0;
+}
+
+/** Opens the directory `output` of `mi`, and makes it if it's not there;
+ if it's in the tree, it's remembered, so it's not read.
+ @return Success. @throws[mkdir, open, fstat, malloc] */
+static int output_root(struct MakeIndex *const mi) {
+	const char *const output = mi->option.output;
+	struct stat st;
+	size_t a, b;
+	if(mkdir(output, 0777) && errno != EEXIST
+		|| (mi->out = open(output, O_RDONLY | O_DIRECTORY)) == -1
+		|| fstat(mi->out, &st)) return 0;
+	mi->skip.dev = st.st_dev, mi->skip.ino = st.st_ino;
+	/* only a directory with the same name can be it */
+	for(b = strlen(output); b > 1 && output[b - 1] == '/'; b--);
+	for(a = b; a && output[a - 1] != '/'; a--);
+	if(!(mi->skip.name = malloc(b - a + 1))) return 0;
+	memcpy(mi->skip.name, output + a, b - a);
+	mi->skip.name[b - a] = '\0';
+	return 1;
+}
+
+/** Reads the templates in the directory `root`; only those that are there
+ are made. It holds `root` open until it's destroyed.
+ @param[options] Null is all the defaults.
+ @return A context or null; the reason is on `stderr`.
+ @throws[malloc, open, read, pthread_mutex_init, EDOM] */
+struct MakeIndex *MakeIndex(const char *const root,
+	const struct MakeIndexOptions *const options) {
+	static const struct MakeIndexOptions defaults;
+	struct MakeIndex *mi;
+	size_t i;
+	assert(root);
+	if(!(mi = malloc(sizeof *mi + strlen(root) + 1)))
+		{ perror("MakeIndex"); return 0; }
+	mi->option = options ? *options : defaults;
+	mi->root = (char *)(mi + 1);
+	strcpy(mi->root, root);
+	mi->fd = mi->out = -1;
+	mi->skip.name = 0;
+	mi->why = "MakeIndex";
+	strcpy(mi->now, "(no time)");
+	mi->index.string = 0;
+	mi->index.parser = 0;
+	mi->each.data = 0, mi->each.size = 0;
+	mi->stream.data = 0, mi->stream.size = 0;
+	mi->feed = 0;
+	mi->snapshot = 0;
+	mi->stats = 0;
+	mi->images = 0;
+	mi->writer = 0;
+	mi->jobs = 0;
+	mi->render.page = mi->render.site = mi->render.gz = 0;
+	mi->render.end = 0;
+	mi->render.batch = 0;
+	mi->cache.head = mi->cache.tail = 0, mi->cache.size = 0;
+	mi->is_lock = 0;
+	mi->next = 0;
+	mi->failed = 0;
+	mi->publish = 0;
+	mi->unwritten = 0;
+	mi->warned.uring = mi->warned.watch = 0;
+	if((mi->fd = open(root, O_RDONLY | O_DIRECTORY)) == -1)
+		{ mi->why = root; goto catch; }
+	if(!mi->option.output) mi->out = mi->fd;
+	else if(!output_root(mi)) { mi->why = mi->option.output; goto catch; }
+	if((errno = pthread_mutex_init(&mi->lock, 0)))
+		{ mi->why = "lock"; goto catch; }
+	mi->is_lock = 1;
+	if(mi->option.stats && !(mi->stats = Stats(stats_slowest)))
+		{ mi->why = "stats"; goto catch; }
+	if(!(mi->images = Images())) { mi->why = "images"; goto catch; }
+
+	/* all the templates, `.<name>.<ext>`, are read once */
+	if(!discover(mi)) goto catch;
+	if(!mi->index.parser) fprintf(stderr, /* Not an error. */
+		"MakeIndex: to make an index, create the file <%s>.\n",
+		template_index);
 
 	/* if there's no content, we have nothing to do */
-	if(!r->index.parser && !r->sitemap.parser && !r->newsfeed.parser)
-		{ why = "no parsers"; errno = EDOM; goto catch; }
-
-	/* parse the "header," ie, everything up to ~, the second arg is null
-	 because we haven't set up the Files, so @files{}, @pwd{}, etc are
-	 undefined */
-	ParserParse(r->sitemap.parser, r->sitemap.fp, 0, 0);
-	ParserParse(r->newsfeed.parser, r->newsfeed.fp, 0, 0);
-	goto finally;
+	if(!mi->index.parser && !mi->each.size && !mi->stream.size)
+		{ mi->why = "no parsers"; errno = EDOM; goto catch; }
+	if(mi->option.profile) {
+		if(mi->index.parser && !ParserProfile(mi->index.parser))
+			{ mi->why = "profile"; goto catch; }
+		for(i = 0; i < mi->each.size; i++)
+			if(!ParserProfile(mi->each.data[i].parser))
+			{ mi->why = "profile"; goto catch; }
+		for(i = 0; i < mi->stream.size; i++)
+			if(!ParserProfile(mi->stream.data[i].t.parser))
+			{ mi->why = "profile"; goto catch; }
+	}
+	return mi;
 catch:
-	/* We don't do anything with `fp` because `read_until_close` already did. */
-	recursor_();
-finally:
-	return r;
+	perror(mi->why);
+	MakeIndex_(&mi);
+	return 0;
+}
+
+/** @return A digest of the templates of `mi` that are in every directory,
+ and the icons at the root, which are on every page, and can have their size
+ on it. */
+static unsigned long templates(const struct MakeIndex *const mi) {
+	const char *icons[2];
+	unsigned long hash = HashString(0, mi->index.string);
+	struct stat st;
+	size_t i;
+	icons[0] = icon_dir, icons[1] = icon_file;
+	for(i = 0; i < mi->each.size; i++) hash = HashString(HashString(hash,
+		mi->each.data[i].name), mi->each.data[i].string);
+	/* the pages are split differently */
+	if(mi->option.page) hash = HashNumber(hash, (unsigned long)mi->option.page);
+	for(i = 0; i < sizeof icons / sizeof *icons; i++) {
+		if(fstatat(mi->fd, icons[i], &st, 0)) continue;
+		hash = HashNumber(HashNumber(HashString(hash, icons[i]),
+			(unsigned long)st.st_size), (unsigned long)st.st_mtime);
+	}
+	return hash;
+}
+
+/** Starts again with the snapshot from last time, with `incremental` or when
+ there are pages, and no news. @return Success. */
+static int start(struct MakeIndex *const mi) {
+	Snapshot_(&mi->snapshot);
+	Feed_(&mi->feed);
+	mi->unwritten = 0;
+	/* the snapshot from last time is only good for the same index; it's also
+	 the pages that were written, so it's kept for those */
+	if(!(mi->snapshot = Snapshot(mi->out, snapshot_file, templates(mi))))
+		{ mi->why = snapshot_file; return 0; }
+	if(!mi->option.incremental && !mi->option.page
+		&& !SnapshotIsPaged(mi->snapshot)) Snapshot_(&mi->snapshot);
+	/* the news is kept until the end */
+	if(has_news(mi) && !(mi->feed = Feed(mi->option.news
+		? mi->option.news : news_max))) { mi->why = "news"; return 0; }
+	return 1;
+}
+
+/** @return Whether `fn` is the temporary file of `name`, or of it
+ compressed, while it's written. */
+static int is_temp(const char *fn, const char *const name) {
+	const size_t len = strlen(name), gz = strlen(dot_gz);
+	if(strncmp(fn, name, len)) return 0;
+	fn += len;
+	if(!strncmp(fn, dot_gz, gz)) fn += gz;
+	return !strcmp(fn, dot_temp);
+}
+
+/** @return The number of the page of the index, from one, that `fn` starts
+ with, (see <fn:WidgetPageName>,) with what's after it in `rest`, or zero. */
+static size_t page_number(const char *const fn, const char **const rest) {
+	const size_t len = strlen(html_index);
+	const char *const dot = strrchr(html_index, '.'),
+		*const ext = dot ? dot : html_index + len;
+	const size_t stem = (size_t)(ext - html_index);
+	unsigned long n;
+	char *end;
+	if(!strncmp(fn, html_index, len)) return *rest = fn + len, 1;
+	if(strncmp(fn, html_index, stem) || fn[stem] != '-'
+		|| fn[stem + 1] < '1' || fn[stem + 1] > '9') return 0;
+	n = strtoul(fn + stem + 1, &end, 10);
+	if(n < 2 || strncmp(end, ext, strlen(ext))) return 0;
+	*rest = end + strlen(ext);
+	return (size_t)n;
+}
+
+/** @return Whether `rest`, what's after the name of something that we write,
+ is nothing, or it's compressed, or temporary. */
+static int is_rest(const char *rest) {
+	if(!strncmp(rest, dot_gz, strlen(dot_gz))) rest += strlen(dot_gz);
+	return !*rest || !strcmp(rest, dot_temp);
+}
+
+/** @return Whether `fn` is something that `mi` writes, in the root if
+ `is_root`. The aggregates themselves are listed. */
+static int is_output(const struct MakeIndex *const mi, const char *const fn,
+	const int is_root) {
+	const char *rest;
+	size_t i, len;
+	if(page_number(fn, &rest) == 1 && is_rest(rest)) return 1;
+	for(i = 0; i < mi->each.size; i++) {
+		len = strlen(mi->each.data[i].name);
+		if(!strncmp(fn, mi->each.data[i].name, len) && is_rest(fn + len))
+			return 1;
+	}
+	if(!is_root) return 0;
+	for(i = 0; i < mi->stream.size; i++)
+		if(is_temp(fn, mi->stream.data[i].t.name)
+		|| !strcmp(fn, mi->stream.data[i].t.gz)) return 1;
+	return !strncmp(fn, snapshot_file, strlen(snapshot_file));
+}
+
+/** @return The number of the page of the index, after the first, that `fn`
+ is, or it's compressed or temporary, or zero. It's only ours if the snapshot
+ says it was written, see <fn:written>. */
+static size_t later_page(const char *const fn) {
+	const char *rest;
+	const size_t n = page_number(fn, &rest);
+	return n > 1 && is_rest(rest) ? n : 0;
+}
+
+/** Puts the directory of `files`, relative to the root, with a `/` after
+ every one, in `dir` of `size`. @return Success. @throws[ERANGE] */
+static int path(struct Files *const files, char *const dir, const size_t size) {
+	const char *name;
+	size_t len = 0, n;
+	assert(files && dir && size);
+	FilesSetPath(files);
+	while((name = FilesEnumPath(files))) {
+		if(len + (n = strlen(name)) + 2 > size)
+			{ while(FilesEnumPath(files)); errno = ERANGE; return 0; }
+		memcpy(dir + len, name, n), len += n;
+		dir[len++] = '/';
+	}
+	dir[len] = '\0';
+	return 1;
+}
+
+/** @return The hash of the path of `files`, which is how it's known in the
+ snapshot. */
+static unsigned long path_hash(struct Files *const files) {
+	const char *name;
+	unsigned long hash = 0;
+	FilesSetPath(files);
+	while((name = FilesEnumPath(files))) hash = HashString(hash, name);
+	return hash;
+}
+
+/** @return How many pages of the index of the directory `path` in `mi` were
+ written last time beside it, or zero if it's not known. */
+static size_t written(const struct MakeIndex *const mi,
+	const unsigned long path) {
+	return mi->snapshot && mi->out == mi->fd
+		? SnapshotPages(mi->snapshot, path) : 0;
+}
+
+/** Offers the news that was just read into `w` in the directory of `files`
+ to the feed of `mi`. @return Success. */
+static int news(struct MakeIndex *const mi, struct Files *const files,
+	const struct Widget *const w) {
+	struct FeedItem item;
+	char dir[1024];
+	int success;
+	assert(mi && mi->feed && files && w);
+	if(!path(files, dir, sizeof dir)) return 0;
+	item.year = w->news.year, item.month = w->news.month,
+		item.day = w->news.day;
+	strcpy(item.title, w->news.title);
+	strcpy(item.name, w->news.name);
+	item.dir = dir;
+	pthread_mutex_lock(&mi->lock);
+	success = FeedAdd(mi->feed, &item);
+	pthread_mutex_unlock(&mi->lock);
+	return success;
+}
+
+/** Keeps the news that was just read into `w` in `n`. @return Success.
+ @throws[realloc] */
+static int node_news(struct node *const n, const struct Widget *const w) {
+	struct FeedItem *item;
+	assert(n && w);
+	if(n->news.size >= n->news.capacity) {
+		const size_t c = n->news.capacity ? n->news.capacity * 2 : 4;
+		if(!(item = realloc(n->news.data, sizeof *item * c))) return 0;
+		n->news.data = item, n->news.capacity = c;
+	}
+	item = n->news.data + n->news.size++;
+	item->year = w->news.year, item->month = w->news.month,
+		item->day = w->news.day;
+	strcpy(item->title, w->news.title);
+	strcpy(item->name, w->news.name);
+	item->dir = n->path;
+	return 1;
+}
+
+/** @return Whether `fn` in `files` is the `output` of `mi`. */
+static int is_output_root(const struct MakeIndex *const mi,
+	const struct Files *const files, const char *const fn) {
+	struct stat st;
+	return !fstatat(FilesFd(files), fn, &st, 0)
+		&& st.st_dev == mi->skip.dev && st.st_ino == mi->skip.ino;
 }
 
 /** @return Binary value that says if `files` say `fn` should be included.
+ News is offered to the feed, using `param`, a `job`.
  @implements FilesFilter */
-static int filter(struct Files *const files, const char *fn) {
-	const char *str;
+static int filter(struct Files *const files, const char *fn,
+	void *const param) {
+	struct job *const job = param;
+	struct MakeIndex *const mi = job->mi;
+	const char *str, *desc;
 	char filed[64];
-	FILE *fd;
-	assert(r);
+	size_t size, n;
+	assert(mi && job);
 	/* *.d[.0]* */
 	for(str = fn; (str = strstr(str, dot_desc)); ) {
 		str += strlen(dot_desc);
-		if(*str == '\0' || *str == '.') return 0;
+		if(*str == '\0' || *str == '.') {
+			/* descriptions and icons show up on the page */
+			if(mi->option.incremental) FilesDepend(files, fn);
+			return 0;
+		}
 	}
 	/* *.news$ */
 	if((str = strstr(fn, dot_news))) {
 		str += strlen(dot_news);
 		if(*str == '\0') {
-			if(WidgetSetNews(fn)
-				&& ParserParse(r->newsfeed.parser, r->newsfeed.fp, files, 0)) {
-				ParserRewind(r->newsfeed.parser);
-			} else {
-				fprintf(stderr, "MakeIndex::filter: error writing news <%s>.\n",
+			if(!mi->feed || !job->is_news) return 0;
+			WidgetClear(&job->widget, mi->now, mi->images);
+			if(!WidgetSetNews(&job->widget, files, fn)
+				|| !(job->node ? node_news(job->node, &job->widget)
+				: news(mi, files, &job->widget))) {
+				fprintf(stderr, "MakeIndex::filter: error adding news <%s>.\n",
 					fn);
+			} else if(mi->option.verbose) {
+				fprintf(stderr, "News <%s>, '%s' %d-%d-%d.\n",
+					job->widget.news.name, job->widget.news.title,
+					job->widget.news.year, job->widget.news.month,
+					job->widget.news.day);
 			}
 			return 0;
 		}
 	}
 	/* Obvious choices for not including. */
-	if(!strcmp(fn, dir_current)
+	if(!strcmp(fn, dir_current) || !strcmp(fn, ignore_file)
 		|| !strcmp(fn, dir_parent) && FilesIsRoot(files)
-		|| !strcmp(fn, html_index)) return 0;
+		|| is_output(mi, fn, FilesIsRoot(files))
+		|| ((n = later_page(fn)) && n <= written(mi, path_hash(files)))
+		|| mi->skip.name && !strcmp(fn, mi->skip.name)
+		&& is_output_root(mi, files, fn)) return 0;
 	/* add .d, check 1 line for \n */
 	if(strlen(fn) > sizeof filed - 1 - strlen(dot_desc))
 		return fprintf(stderr,
@@ -230,62 +895,1012 @@ static int filter(struct Files *const files, const char *fn) {
 		fn, (unsigned long)sizeof filed), 0;
 	strcpy(filed, fn);
 	strcat(filed, dot_desc);
-	if((fd = fopen(filed, "r"))) {
-		int ch = fgetc(fd);
-		if(fclose(fd)) perror(filed);
-		if(ch == '\n' || ch == '\r' || ch == EOF) return fprintf(stderr,
-			"MakeIndex::filter: '%s' rejected because .d.\n", fn), 0;
+	if((desc = FilesRead(files, filed, &size))) {
+		if(!size || *desc == '\n' || *desc == '\r') {
+			if(mi->option.verbose) fprintf(stderr,
+				"MakeIndex::filter: '%s' rejected because .d.\n", fn);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/** @return How many pages the index of `f` is on in `mi`; one, unless there
+ are more files than `page`. */
+static size_t pages(const struct MakeIndex *const mi,
+	const struct Files *const f) {
+	const size_t size = mi->option.page, count = FilesCount(f);
+	return size && count > size ? (count + size - 1) / size : 1;
+}
+
+/** @return Whether all the pages of the index of `f` in `mi`, and the rest
+ of the templates of the directory, are there, in `fd`, and, with `gzip`,
+ their compressed siblings. */
+static int is_published(const struct MakeIndex *const mi,
+	const struct Files *const f, const int fd) {
+	char name[64], gz[64 + 8];
+	size_t n;
+	const size_t p = pages(mi, f);
+	for(n = 1; n <= p; n++) {
+		WidgetPageName(&name, n);
+		strcpy(gz, name), strcat(gz, dot_gz);
+		if(faccessat(fd, name, F_OK, 0) || mi->option.gzip
+			&& faccessat(fd, gz, F_OK, 0)) return 0;
 	}
+	for(n = 0; n < mi->each.size; n++)
+		if(faccessat(fd, mi->each.data[n].name, F_OK, 0) || mi->option.gzip
+		&& faccessat(fd, mi->each.data[n].gz, F_OK, 0)) return 0;
 	return 1;
 }
 
-/** Called recursively with `parent` initially set to null. @return True. */
-static int recurse(struct Files *const parent) {
+/** With `incremental`, @return Whether the index of `f`, which is `path`, in
+ `fd`, is the same as last time. */
+static int unchanged(struct MakeIndex *const mi, struct Files *const f,
+	const unsigned long path, const int fd) {
+	char buf[256];
+	const char *name;
+	assert(mi && mi->snapshot);
+	/* the descriptions of the sub-directories, including the parent */
+	while(FilesAdvance(f)) {
+		if(!FilesIsDir(f)) continue;
+		FilesDependTotal(f);
+		if(!(name = FilesName(f))) continue;
+		if(strlen(name) + 1 + strlen(html_desc) >= sizeof buf)
+			{ FilesDepend(f, name); continue; }
+		strcpy(buf, name);
+		strcat(buf, "/");
+		strcat(buf, html_desc);
+		FilesDepend(f, buf);
+	}
+	return SnapshotSame(mi->snapshot, path, FilesInputs(f))
+		&& is_published(mi, f, fd);
+}
+
+/** Records in the snapshot of `mi` that the directory `path` has `inputs`,
+ and `pages` of the index, for next time. */
+static void record(struct MakeIndex *const mi, const unsigned long path,
+	const unsigned long inputs, const size_t pages) {
+	pthread_mutex_lock(&mi->lock);
+	if(!SnapshotPut(mi->snapshot, path, inputs, pages)) perror(snapshot_file);
+	pthread_mutex_unlock(&mi->lock);
+}
+
+/** Renders page `n`, from one, of the `pages` of `f` with `parser` into
+ `job`; with more than one, `@(files)` only goes over it's part of the
+ listing. */
+static void page(struct Files *const f, struct job *const job,
+	const struct Parser *const parser, const size_t n, const size_t pages) {
+	const size_t size = job->mi->option.page;
+	const double t = StatsStart(job->stats);
+	assert(n && n <= pages);
+	TextClear(job->page);
+	WidgetClear(&job->widget, job->mi->now, job->mi->images);
+	job->widget.page = n, job->widget.pages = pages;
+	if(pages > 1) FilesSetPage(f, (n - 1) * size, size);
+	ParserParse(parser, head, job->page, f, &job->widget);
+	if(pages > 1) FilesSetPage(f, 0, 0);
+	StatsStop(job->stats, StatsRender, t, 1);
+}
+
+/** Remembers in `mi` that a page wasn't written because of `e`; the
+ first one is why the build fails, see <fn:MakeIndexBuild>. */
+static void unwritten(struct MakeIndex *const mi, const int e) {
+	pthread_mutex_lock(&mi->lock);
+	if(!mi->unwritten) mi->unwritten = e ? e : EIO;
+	pthread_mutex_unlock(&mi->lock);
+}
+
+/** Writes the page that was rendered in `job` to `name` in `fd`; with
+ `gzip`, also it's compressed sibling, if the page changed or it's not
+ there. With a writer, it's given to that, and `job` has a new page. */
+static void publish(const int fd, struct job *const job,
+	const char *const name) {
+	char name_gz[64 + 8];
+	double t;
+	int written = 0, gz = 0;
+	assert(strlen(name) < 64);
+	if(job->writer) {
+		if(WriterPut(job->writer, fd, name, &job->page)) return;
+		perror(name); /* then it's here */
+	}
+	t = StatsStart(job->stats);
+	strcpy(name_gz, name), strcat(name_gz, dot_gz);
+	if(!TextPublish(job->page, fd, name, &written))
+		{ unwritten(job->mi, errno); perror(name); goto finally; }
+	if(written) StatsBytes(job->stats, (unsigned long)TextSize(job->page));
+	if(!job->mi->option.gzip || !written
+		&& !faccessat(fd, name_gz, F_OK, 0)) goto finally;
+	if(!TextGzip(job->page, job->gz)
+		|| !TextPublish(job->gz, fd, name_gz, &gz))
+		unwritten(job->mi, errno), perror(name_gz);
+	if(gz) StatsBytes(job->stats, (unsigned long)TextSize(job->gz));
+finally:
+	StatsStop(job->stats, StatsWrite, t, (unsigned long)(!!written + !!gz));
+}
+
+/** Removes the pages of the index in `fd` after `pages`, up to `was`, that
+ were written when it had more; nothing else with the name is touched. */
+static void prune(const int fd, const size_t pages, const size_t was) {
+	char name[64], gz[64 + 8];
+	size_t n;
+	for(n = pages + 1; n <= was; n++) {
+		WidgetPageName(&name, n);
+		strcpy(gz, name), strcat(gz, dot_gz);
+		if(unlinkat(fd, name, 0) && errno != ENOENT) perror(name);
+		if(unlinkat(fd, gz, 0) && errno != ENOENT) perror(gz);
+	}
+}
+
+/** @return Where the outputs of `f` in `mi` go; it's the directory of `f`,
+ unless there's `output`, then it's the same place under that, made if it's
+ not there, and it has to be closed. Or -1.
+ @throws[mkdirat, openat, dup, ERANGE] */
+static int output(const struct MakeIndex *const mi, struct Files *const f) {
+	char where[1024], *a, *b;
+	int fd, next;
+	if(mi->out == mi->fd) return FilesFd(f);
+	if(!path(f, where, sizeof where)) return -1;
+	if(!*where) return dup(mi->out);
+	if((fd = openat(mi->out, where, O_RDONLY | O_DIRECTORY)) != -1
+		|| errno != ENOENT || (fd = dup(mi->out)) == -1) return fd;
+	/* the first time, (or it was taken away) */
+	for(a = where; (b = strchr(a, '/')); a = b + 1) {
+		*b = '\0';
+		if(mkdirat(fd, a, 0777) && errno != EEXIST
+			|| (next = openat(fd, a, O_RDONLY | O_DIRECTORY)) == -1)
+			{ const int e = errno; close(fd); errno = e; return -1; }
+		close(fd), fd = next;
+	}
+	return fd;
+}
+
+/** Reads the directory `dir` in `parent`, (both null for the root,) and
+ renders it's part of the aggregates with `job`; the index is left for
+ <fn:finish>, when the sub-directories have their totals. The time it took is
+ in `elapsed`. @return The directory or null. */
+static struct Files *directory(struct Files *const parent,
+	const struct File *const dir, struct job *const job,
+	double *const elapsed) {
+	struct MakeIndex *const mi = job->mi;
 	struct Files *f;
-	const char   *name;
-	FILE         *fp;
-	if(!(f = Files(parent, &filter))) { why = "files"; return 0; }
-	/* write the index */
-	if((fp = fopen(html_index, "w"))) {
-		ParserParse(r->index.parser, fp, f, 0);
-		ParserRewind(r->index.parser);
-		fclose(fp);
-	} else perror(html_index); /* fixme: this should be an error */
-	/* sitemap */
-	ParserParse(r->sitemap.parser, r->sitemap.fp, f, 0);
-	ParserRewind(r->sitemap.parser);
+	char where[1024];
+	const double start = StatsStart(job->stats);
+	double t;
+	size_t i, n = 0;
+	*elapsed = 0.0;
+	if(!(f = Files(mi->fd, parent, dir, job->batch, job->stats, &filter, job)))
+		return 0;
+	/* the aggregates are only there at the end, but they're on the first */
+	if(!parent && mi->out == mi->fd) for(i = 0; i < mi->stream.size; i++)
+		if(mi->stream.data[i].fd != -1 && !FilesExpect(f,
+		mi->stream.data[i].t.name, &filter, job)) perror(html_index);
+	if(mi->option.verbose && path(f, where, sizeof where))
+		fprintf(stderr, "Files: directory <%s>.\n", where);
+	/* the aggregates of every directory, like the sitemap */
+	t = StatsStart(job->stats);
+	for(i = 0; i < mi->stream.size; i++) {
+		struct stream *const s = mi->stream.data + i;
+		if(!s->is_news) {
+			WidgetClear(&job->widget, mi->now, mi->images);
+			ParserParse(s->t.parser, body, job->site ? job->site : s->text,
+				f, &job->widget), n++;
+		}
+		if(job->site) job->end[i] = TextSize(job->site);
+	}
+	StatsStop(job->stats, StatsRender, t, (unsigned long)n);
+	*elapsed = StatsStart(job->stats) - start;
+	return f;
+}
+
+/** Writes the index of `f` with `job`, after everything under it, and puts the
+ total of it in `total`; the sub-directories that have been set with
+ <fn:FilesSetTotal> show it. `elapsed` is the time from <fn:directory>. */
+static void finish(struct Files *const f, struct job *const job,
+	const double elapsed, struct FilesTotal *const total) {
+	struct MakeIndex *const mi = job->mi;
+	char where[1024], name[64];
+	const double start = StatsStart(job->stats);
+	double t;
+	unsigned long at = 0;
+	size_t n, p = pages(mi, f), was = 0;
+	int fd;
+	FilesSum(f, total);
+	if(mi->snapshot) at = path_hash(f), was = SnapshotPages(mi->snapshot, at);
+	if((fd = output(mi, f)) == -1) {
+		unwritten(mi, errno);
+		perror(path(f, where, sizeof where) ? where : html_index);
+		p = was; /* they're still there */
+	} else if(mi->option.incremental && unchanged(mi, f, at, fd)) {
+		/* nothing to do */
+	} else {
+		/* a page at a time, so it's only as big as one */
+		for(n = 1; n <= p; n++) {
+			WidgetPageName(&name, n);
+			page(f, job, mi->index.parser, n, p), publish(fd, job, name);
+		}
+		prune(fd, p, was);
+		/* the others are all on one */
+		for(n = 0; n < mi->each.size; n++) {
+			page(f, job, mi->each.data[n].parser, 1, 1);
+			publish(fd, job, mi->each.data[n].name);
+		}
+	}
+	if(fd != -1 && fd != FilesFd(f) && close(fd)) perror(html_index);
+	/* the digest is only good if all the inputs are in it */
+	if(mi->snapshot) record(mi, at, fd != -1 && mi->option.incremental
+		? FilesInputs(f) : 0, p);
+	/* only the slow ones need a name */
+	if(StatsIsSlow(job->stats, t = StatsDirectory(job->stats, start) + elapsed)
+		&& (!path(f, where, sizeof where)
+		|| !StatsSlow(job->stats, where, t))) perror("stats");
+}
+
+/** @return Whether the selected file of `f` is a directory to go into. */
+static int is_subdirectory(const struct Files *const f) {
+	const char *name;
+	return FilesIsDir(f) && (name = FilesName(f))
+		&& strcmp(dir_current, name) && strcmp(dir_parent, name);
+}
+
+/** Called recursively with `parent` initially set to null; the aggregates
+ are in pre-order, and the index in post-order, so that `dir` in `parent` gets
+ the total. Only the directories above are held. @return True. */
+static int recurse(struct Files *const parent, const struct File *const dir,
+	struct job *const job) {
+	struct MakeIndex *const mi = job->mi;
+	struct Files *f;
+	struct FilesTotal total;
+	double elapsed;
+	if(!(f = directory(parent, dir, job, &elapsed)))
+		{ mi->why = "files"; return 0; }
+	streams_drain(mi);
 	/* recurse */
 	while(FilesAdvance(f)) {
-		if(!FilesIsDir(f) ||
-		   !(name = FilesName(f)) ||
-		   !strcmp(dir_current, name) ||
-		   !strcmp(dir_parent,  name) ||
-		   !(name = FilesName(f))) continue;
-		if(chdir(name)) { perror(name); continue; }
-		if(!recurse(f)) return 0;
-		/* this happens on Windows; I don't know what to do */
-		if(chdir(dir_parent)) perror(dir_parent);
+		if(!is_subdirectory(f)) continue;
+		if(!recurse(f, FilesThis(f), job)) { Files_(f); return 0; }
 	}
+	finish(f, job, elapsed, &total);
+	if(parent) FilesSetTotal(parent, dir, &total);
 	Files_(f);
 	return 1;
 }
 
-/** Make sure that `argc`, `argv`, aren't expecting user input. */
-int main(int argc, char **argv) {
-	int ret = EXIT_FAILURE;
-	(void)argv;
-	if(argc != 1) { why = "arguments"; errno = EDOM; goto catch; }
-	/* make sure that umask is set so that others can read what we create */
-	umask((mode_t)(S_IWGRP | S_IWOTH));
-	/* recursing */
-	if(!recursor() || !recurse(0)) goto catch;
-	ret = EXIT_SUCCESS;
+/** @return A new task of `mi` for `dir` in `parent`, (null for the root,) or
+ null. @throws[malloc] */
+static struct task *task(struct MakeIndex *const mi,
+	struct task *const parent, const struct File *const dir) {
+	struct task *t;
+	if(!(t = malloc(sizeof *t))) return 0;
+	t->mi = mi;
+	t->parent = parent, t->child = t->next = 0;
+	t->files = 0;
+	t->dir = dir;
+	t->refs = 2; /* until it's output, and until it's index is written */
+	t->pending = 1; /* itself */
+	t->done = 0;
+	t->elapsed = 0.0;
+	t->site.end = 0, t->site.buf = 0;
+	return t;
+}
+
+/** Drops a reference to `t`; frees it and then it's parents if it's the last.
+ Must have the lock. */
+static void release(struct task *t) {
+	struct task *parent;
+	while(t && !--t->refs) {
+		parent = t->parent;
+		Files_(t->files);
+		free(t->site.end);
+		free(t);
+		t = parent;
+	}
+}
+
+/** Puts `frag` in it's streams of `mi`. */
+static void fragment(struct MakeIndex *const mi,
+	const struct fragment *const frag) {
+	size_t i, a;
+	if(!frag->end) return;
+	for(a = 0, i = 0; i < mi->stream.size; a = frag->end[i++]) {
+		TextCat(mi->stream.data[i].text, frag->buf + a, frag->end[i] - a);
+		stream_drain(mi, mi->stream.data + i, 0);
+	}
+}
+
+/** Outputs all the tasks of `mi` that are done, in the order of the serial
+ run, up to the first one that isn't. Must have the lock. */
+static void emit(struct MakeIndex *const mi) {
+	struct task *t, *up;
+	while((t = mi->next) && t->done) {
+		fragment(mi, &t->site);
+		/* pre-order */
+		if(t->child) mi->next = t->child;
+		else {
+			for(up = t; up && !up->next; up = up->parent);
+			mi->next = up ? up->next : 0;
+		}
+		release(t);
+	}
+}
+
+/** Copies what's in the `site` of `job` to `frag` and clears it.
+ @return Success. @throws[malloc] */
+static int keep(struct job *const job, struct fragment *const frag) {
+	const size_t streams = job->mi->stream.size;
+	const char *data;
+	size_t size;
+	if(!(data = TextData(job->site, &size)) || !size) return 1;
+	if(TextIsError(job->site)) { errno = ENOMEM; return 0; }
+	if(!(frag->end = malloc(sizeof *frag->end * streams + size))) return 0;
+	memcpy(frag->end, job->end, sizeof *frag->end * streams);
+	frag->buf = (char *)(frag->end + streams);
+	memcpy(frag->buf, data, size);
+	TextClear(job->site);
+	return 1;
+}
+
+/** One of the subtrees that `t` is waiting on is done, in `job`; if it's the
+ last, the index of `t` is written, it's total goes to it's parent, and so on
+ up. */
+static void complete(struct task *t, struct job *const job) {
+	struct MakeIndex *const mi = t->mi;
+	struct task *parent;
+	struct FilesTotal total;
+	int is_last;
+	while(t) {
+		pthread_mutex_lock(&mi->lock);
+		is_last = !--t->pending;
+		pthread_mutex_unlock(&mi->lock);
+		if(!is_last) return;
+		if(t->files) finish(t->files, job, t->elapsed, &total);
+		pthread_mutex_lock(&mi->lock);
+		/* the parent is waiting for this, so it's still there */
+		if((parent = t->parent) && t->files)
+			FilesSetTotal(parent->files, t->dir, &total);
+		release(t);
+		pthread_mutex_unlock(&mi->lock);
+		t = parent;
+	}
+}
+
+/** Reads and renders a directory, and then pushes the sub-directories; the
+ index is written when they're done. @implements PoolTask */
+static void run(struct Pool *const pool, const unsigned worker,
+	void *const param) {
+	struct task *const t = param, *c, *next, *first;
+	struct MakeIndex *const mi = t->mi;
+	struct job *const job = mi->jobs + worker;
+	struct Files *f = 0;
+	size_t n;
+	int ok = 1;
+	TextClear(job->site);
+	if(!(f = directory(t->parent ? t->parent->files : 0, t->dir, job,
+		&t->elapsed))) ok = 0;
+	if(!keep(job, &t->site)) perror("site"), ok = 0;
+	t->files = f;
+	/* the sub-directories, backwards, because the last pushed is done first;
+	 nothing is output below `t` until it's done, so they stay */
+	for(first = 0, n = 0; f && FilesAdvance(f); ) {
+		if(!is_subdirectory(f)) continue;
+		if(!(c = task(mi, t, FilesThis(f))))
+			{ perror("task"); ok = 0; continue; }
+		c->next = first, first = c, n++;
+	}
+	pthread_mutex_lock(&mi->lock);
+	t->pending += n;
+	pthread_mutex_unlock(&mi->lock);
+	for(c = first; c; c = c->next) if(!PoolPush(pool, worker, c)) {
+		perror("task");
+		pthread_mutex_lock(&mi->lock);
+		c->done = 1, ok = 0;
+		pthread_mutex_unlock(&mi->lock);
+		complete(c, job);
+	}
+	for(c = first, next = 0; c; c = first) /* forwards for the output */
+		first = c->next, c->next = next, next = c;
+	pthread_mutex_lock(&mi->lock);
+	if(!ok) mi->failed = 1;
+	t->child = next;
+	t->refs += n;
+	t->done = 1;
+	emit(mi);
+	pthread_mutex_unlock(&mi->lock);
+	complete(t, job);
+}
+
+/** @return With `uring`, a batch for one thread, or null, in which case it's
+ read one at a time, as usual. */
+static struct Batch *batch(struct MakeIndex *const mi) {
+	struct Batch *b;
+	if(!mi->option.uring) return 0;
+	if(!(b = Batch(batch_depth))) {
+		pthread_mutex_lock(&mi->lock);
+		if(!mi->warned.uring) mi->warned.uring = 1, perror("io_uring"),
+			fprintf(stderr,
+			"MakeIndex: falling back to reading one at a time.\n");
+		pthread_mutex_unlock(&mi->lock);
+	}
+	return b;
+}
+
+/** Initialises `job` of `mi` to nothing, to be filled in. */
+static void job(struct MakeIndex *const mi, struct job *const job) {
+	job->mi = mi;
+	job->page = job->site = job->gz = 0;
+	job->end = 0;
+	job->batch = 0;
+	job->writer = mi->writer;
+	job->node = 0;
+	job->stats = 0;
+	job->is_news = 1;
+}
+
+/** Frees the first `n` of `mi->jobs`. */
+static void jobs_(struct MakeIndex *const mi, const unsigned n) {
+	unsigned i;
+	if(!mi->jobs) return;
+	for(i = 0; i < n; i++) {
+		Text_(&mi->jobs[i].page);
+		Text_(&mi->jobs[i].site);
+		free(mi->jobs[i].end);
+		Text_(&mi->jobs[i].gz);
+		Batch_(&mi->jobs[i].batch);
+		if(!StatsMerge(mi->stats, mi->jobs[i].stats)) perror("stats");
+		Stats_(&mi->jobs[i].stats);
+	}
+	free(mi->jobs), mi->jobs = 0;
+}
+
+/** @return Whether it made `n` jobs with their own buffers in `mi->jobs`. */
+static int jobs(struct MakeIndex *const mi, const unsigned n) {
+	unsigned i;
+	assert(mi && !mi->jobs);
+	if(!(mi->jobs = malloc(sizeof *mi->jobs * n))) return 0;
+	for(i = 0; i < n; i++) {
+		struct job *const j = mi->jobs + i;
+		job(mi, j);
+		if(!(j->page = Text()) || !(j->site = Text()) || mi->stream.size
+			&& !(j->end = malloc(sizeof *j->end * mi->stream.size))
+			|| mi->option.gzip && !(j->gz = Text())
+			|| mi->stats && !(j->stats = Stats(stats_slowest))) {
+			Text_(&j->page), Text_(&j->site), free(j->end), Text_(&j->gz);
+			jobs_(mi, i);
+			return 0;
+		}
+		j->batch = batch(mi);
+	}
+	return 1;
+}
+
+/** Recurses on `mi->option.threads` threads. @return Success. */
+static int parallel(struct MakeIndex *const mi) {
+	const unsigned threads = mi->option.threads;
+	struct Pool *pool = 0;
+	struct task *root = 0;
+	int success = 0;
+	assert(mi && threads > 1);
+	mi->failed = 0;
+	if(!jobs(mi, threads)) { mi->why = "jobs"; goto finally; }
+	if(!(pool = Pool(threads, &run)) || !(root = task(mi, 0, 0))
+		|| !PoolPush(pool, 0, root)) { mi->why = "pool"; goto finally; }
+	mi->next = root, root = 0;
+	if(!PoolRun(pool)) { mi->why = "pool"; goto finally; }
+	if(mi->failed) { mi->why = "files"; goto finally; }
+	success = 1;
+finally:
+	free(root);
+	Pool_(&pool);
+	jobs_(mi, threads);
+	return success;
+}
+
+/** Recurses on this thread. @return Success. */
+static int serial(struct MakeIndex *const mi) {
+	struct job j;
+	int success;
+	assert(mi);
+	job(mi, &j);
+	if(!(j.page = Text()) || mi->option.gzip && !(j.gz = Text()))
+		{ Text_(&j.page); mi->why = "page"; return 0; }
+	j.batch    = batch(mi);
+	j.stats    = mi->stats;
+	success = recurse(0, 0, &j);
+	Batch_(&j.batch);
+	Text_(&j.gz);
+	Text_(&j.page);
+	return success;
+}
+
+/** Builds all the directories under the root of `mi`, and the aggregates;
+ with `threads`, in parallel. The outputs are only replaced if
+ it works. @return Success; the reason is on `stderr`. */
+int MakeIndexBuild(struct MakeIndex *const mi) {
+	int success = 0;
+	assert(mi);
+	mi->publish = 0;
+	/* the time is the same on every page */
+	if(!start(mi)) goto catch;
+	if(!WidgetSetNow(&mi->now)) { mi->why = "SOURCE_DATE_EPOCH"; goto catch; }
+	/* the pages are written behind reading the next directories */
+	if(!(mi->writer = Writer(mi->option.threads > 1 ? mi->option.threads : 1,
+		mi->option.gzip, mi->stats))) { mi->why = "writer"; goto catch; }
+	/* parse the "header," ie, everything up to ~ */
+	if(!streams_begin(mi)
+		|| !(mi->option.threads > 1 ? parallel(mi) : serial(mi))) goto catch;
+	if(!WriterWait(mi->writer)) { mi->why = "writer"; goto catch; }
+	if(mi->unwritten)
+		{ errno = mi->unwritten; mi->why = "output"; goto catch; }
+	if(mi->snapshot && !SnapshotWrite(mi->snapshot))
+		{ mi->why = snapshot_file; goto catch; }
+	mi->publish = success = 1;
 	goto finally;
 catch:
-	perror(why);
-	fputc('\n', stdout);
-	usage();
+	perror(mi->why);
+finally:
+	Writer_(&mi->writer);
+	streams_end(mi);
+	mi->publish = 0;
+	return success;
+}
+
+/** Lets go of the least recently used in `mi` that has nothing under it, but
+ not `keep`, until there's room. */
+static void evict(struct MakeIndex *const mi,
+	const struct listing *const keep) {
+	struct listing *x;
+	const size_t max = mi->option.cache ? mi->option.cache : cache_max;
+	while(mi->cache.size > max) {
+		for(x = mi->cache.tail; x && (x->children || x == keep); x = x->prev);
+		if(!x) break; /* all in use */
+		listing_(mi, x);
+	}
+}
+
+/** Finds the listing of `name`, of `len`, which is `dir` in `parent`, (all
+ null for the root,) in `mi`; if it's not there, or it's directory changed,
+ it's read again. @return The listing or null. @throws[malloc, fstatat] */
+static struct listing *listing(struct MakeIndex *const mi,
+	struct listing *const parent, const struct File *const dir,
+	const char *const name, const size_t len) {
+	struct job *const job = &mi->render;
+	struct listing *l;
+	struct stat st;
+	const size_t up = parent ? strlen(parent->path) : 0;
+	char *path;
+	if(!(path = malloc(up + len + 2))) return 0;
+	if(up) memcpy(path, parent->path, up);
+	memcpy(path + up, name, len);
+	if(len) path[up + len] = '/', path[up + len + 1] = '\0';
+	else path[up] = '\0';
+	if(fstatat(mi->fd, *path ? path : dir_current, &st, 0))
+		{ free(path); return 0; }
+	for(l = mi->cache.head; l && strcmp(l->path, path); l = l->next);
+	if(l && l->dev == st.st_dev && l->ino == st.st_ino
+		&& l->mtime.tv_sec == st.st_mtim.tv_sec
+		&& l->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+		/* the same; it's the most recent */
+		free(path);
+		if(l == mi->cache.head) return l;
+		l->prev->next = l->next;
+		if(l->next) l->next->prev = l->prev; else mi->cache.tail = l->prev;
+		l->prev = 0, l->next = mi->cache.head, mi->cache.head->prev = l;
+		mi->cache.head = l;
+		return l;
+	}
+	if(l) forget(mi, l);
+	if(!(l = malloc(sizeof *l))) { free(path); return 0; }
+	l->path = path;
+	l->dev = st.st_dev, l->ino = st.st_ino, l->mtime = st.st_mtim;
+	l->children = 0;
+	if(!(l->files = Files(mi->fd, parent ? parent->files : 0, dir, job->batch,
+		job->stats, &filter, job))) { free(path); free(l); return 0; }
+	if((l->parent = parent)) parent->children++;
+	l->prev = 0, l->next = mi->cache.head;
+	if(mi->cache.head) mi->cache.head->prev = l; else mi->cache.tail = l;
+	mi->cache.head = l;
+	mi->cache.size++;
+	evict(mi, l);
+	return l;
+}
+
+/** Goes down `rest` from the root of `mi`, with the listings that are kept
+ if they are the same, and renders the index of the last one in
+ `mi->render`. @return Success. @throws[malloc, fstatat, ENOENT] */
+static int render(struct MakeIndex *const mi, const char *rest,
+	const size_t n) {
+	struct listing *l;
+	const struct File *dir;
+	const char *name;
+	size_t len, p;
+	if(!(l = listing(mi, 0, 0, "", 0))) return 0;
+	for( ; ; ) {
+		while(*rest == '/') rest++;
+		if(!*rest) break;
+		for(len = 0; rest[len] && rest[len] != '/'; len++);
+		/* it's read to the end, so it's ready for the next one */
+		for(dir = 0; FilesAdvance(l->files); ) if(!dir
+			&& is_subdirectory(l->files) && (name = FilesName(l->files))
+			&& !strncmp(name, rest, len) && !name[len])
+			dir = FilesThis(l->files);
+		if(!dir) { errno = ENOENT; return 0; }
+		if(!(l = listing(mi, l, dir, rest, len))) return 0;
+		rest += len;
+	}
+	if((p = pages(mi, l->files)) < n) { errno = ENOENT; return 0; }
+	page(l->files, &mi->render, mi->index.parser, n ? n : 1, p);
+	return 1;
+}
+
+/** Renders the index of the directory `dir`, relative to the root of `mi`,
+ in memory, without writing anything or offering it's news; it's `page`, from
+ one, if it's on more than one, or zero is the first. It has `size`.
+ The listings of the directories are kept, the most recently used `cache` of
+ them, and only read again when their directory is changed; it's holding them
+ open, and changes to the files in them that don't change the directory,
+ (written in place,) are not seen. Nothing under it is read, so the
+ sub-directories have no total, (`@(filesize)`, `@(dircount)`, `@(lastmod)`.)
+ @return The page, good until the next call, or null; the reason is on
+ `stderr`. @throws[malloc, open, ENOENT, EDOM] */
+const char *MakeIndexRender(struct MakeIndex *const mi, const char *const dir,
+	const size_t page, size_t *const size) {
+	assert(mi && dir && size);
+	if(!mi->index.parser)
+		{ mi->why = template_index; errno = EDOM; goto catch; }
+	if(!mi->render.page) {
+		job(mi, &mi->render);
+		mi->render.is_news = 0;
+		mi->render.stats = mi->stats;
+		if(!(mi->render.page = Text())) { mi->why = "page"; goto catch; }
+		mi->render.batch = batch(mi);
+		/* only for the pages that were written, which aren't listed */
+		if(!mi->snapshot && !(mi->snapshot = Snapshot(mi->out, snapshot_file,
+			templates(mi)))) { mi->why = snapshot_file; goto catch; }
+	}
+	if(!WidgetSetNow(&mi->now)) { mi->why = "SOURCE_DATE_EPOCH"; goto catch; }
+	if(!render(mi, dir, page)) { mi->why = dir; goto catch; }
+	if(TextIsError(mi->render.page))
+		{ errno = ENOMEM; mi->why = dir; goto catch; }
+	return TextData(mi->render.page, size);
+catch:
+	perror(mi->why);
+	return 0;
+}
+
+/** Serves the index of every directory of `mi`, rendered when it's asked for
+ with <fn:MakeIndexRender>, at `<dir>/` or `<dir>/index.html`, and the rest of
+ it's pages, `<dir>/index-2.html`, on `address`,
+ (see <fn:Server>,) until `stop` is set, which is looked at after every
+ request, and when a signal comes. Nothing is written.
+ @return Success; the reason is on `stderr`. */
+int MakeIndexServe(struct MakeIndex *const mi, const char *const address,
+	const volatile sig_atomic_t *const stop) {
+	struct Server *server;
+	struct ServerRequest req;
+	const char *page, *rest;
+	char *last;
+	size_t size, n;
+	int success = 0;
+	assert(mi && address && stop);
+	if(!(server = Server(address))) { perror(address); return 0; }
+	fprintf(stderr, "MakeIndex: serving on <%s>.\n", address);
+	while(!*stop) {
+		if(ServerNext(server, &req) < 0) {
+			if(errno == EINTR) continue;
+			perror(address); goto finally;
+		}
+		/* only the pages are here */
+		last = strrchr(req.path, '/');
+		rest = "";
+		if(!(n = last[1] ? page_number(last + 1, &rest) : 1) || *rest)
+			{ ServerReply(server, 404, 0, 0); continue; }
+		last[1] = '\0';
+		if(mi->option.verbose) fprintf(stderr, "Serving <%s>.\n", req.path);
+		if(!(page = MakeIndexRender(mi, req.path + 1, n, &size))) {
+			ServerReply(server, errno == ENOENT ? 404 : 500, 0, 0);
+			continue;
+		}
+		if(!ServerReply(server, 200, page, size)) perror(address);
+	}
+	success = 1;
 finally:
-	recursor_();
-	return ret;
+	Server_(&server);
+	return success;
+}
+
+/** @return Whether `n` is the directory `name`. */
+static int is_named(const struct node *const n, const char *const name) {
+	const size_t len = strlen(name);
+	return !strncmp(n->name, name, len) && n->name[len] == '/';
+}
+
+/** Frees `n` and everything under it, and stops watching them. */
+static void node_(struct watcher *const wt, struct node *const n) {
+	struct node *c;
+	if(!n) return;
+	while((c = n->child)) n->child = c->next, node_(wt, c);
+	if(n->wd != -1) WatchRemove(wt->watch, n->wd), wt->wds.data[n->wd] = 0;
+	free(n->site.end);
+	free(n->news.data);
+	free(n->path);
+	free(n);
+}
+
+/** Watches the directory of `n` and remembers it; if it can't, it isn't
+ watched, and we say so once. */
+static void watch_node(struct watcher *const wt, struct node *const n) {
+	const char *const root = wt->mi->root;
+	char *where;
+	size_t wd, size;
+	n->wd = -1;
+	/* inotify only takes a path */
+	if(!(where = malloc(strlen(root) + strlen(n->path) + 2))) goto catch;
+	strcpy(where, root);
+	strcat(where, "/");
+	strcat(where, n->path);
+	n->wd = WatchAdd(wt->watch, where);
+	free(where);
+	if(n->wd == -1) goto catch;
+	if((wd = (size_t)n->wd) >= wt->wds.size) {
+		struct node **data;
+		for(size = wt->wds.size ? wt->wds.size : 64; size <= wd; size *= 2);
+		if(!(data = realloc(wt->wds.data, sizeof *data * size)))
+			{ WatchRemove(wt->watch, n->wd), n->wd = -1; goto catch; }
+		while(wt->wds.size < size) data[wt->wds.size++] = 0;
+		wt->wds.data = data;
+	}
+	wt->wds.data[wd] = n;
+	return;
+catch:
+	if(!wt->mi->warned.watch) wt->mi->warned.watch = 1,
+		perror(*n->path ? n->path : dir_current),
+		fprintf(stderr, "MakeIndex: not watching some directories.\n");
+}
+
+/** @return A new, dirty, watched node for the directory `name` in `parent`,
+ (null and empty for the root,) or null. @throws[malloc] */
+static struct node *node(struct watcher *const wt, struct node *const parent,
+	const char *const name) {
+	struct node *n;
+	const size_t up = parent ? strlen(parent->path) : 0;
+	size_t len = strlen(name);
+	if(!(n = malloc(sizeof *n))) return 0;
+	if(!(n->path = malloc(up + len + 2))) { free(n); return 0; }
+	if(up) memcpy(n->path, parent->path, up);
+	memcpy(n->path + up, name, len);
+	if(len) n->path[up + len++] = '/';
+	n->path[up + len] = '\0';
+	n->name = n->path + up;
+	n->hash = parent ? HashString(parent->hash, name) : 0;
+	n->parent = parent, n->child = n->next = 0;
+	n->dirty = 1, n->below = 0;
+	n->total.bytes = n->total.files = n->total.newest = 0;
+	n->site.end = 0, n->site.buf = 0;
+	n->news.data = 0, n->news.size = n->news.capacity = 0;
+	watch_node(wt, n);
+	return n;
+}
+
+/** Marks `n` to be rendered again. */
+static void mark(struct node *n) {
+	n->dirty = 1;
+	for(n = n->parent; n && !n->below; n = n->parent) n->below = 1;
+}
+
+/** Marks `n` and everything under it. */
+static void mark_all(struct node *n) {
+	for( ; n; n = n->next) n->dirty = 1, n->below = 1, mark_all(n->child);
+}
+
+/** Marks the directories that `e` changed. */
+static void touched(struct watcher *const wt,
+	const struct WatchEvent *const e) {
+	struct node *n, *c;
+	size_t p;
+	if(e->overflow) {
+		fprintf(stderr, "MakeIndex: lost changes; reading everything.\n");
+		mark_all(wt->root);
+		return;
+	}
+	if(e->wd < 0 || (size_t)e->wd >= wt->wds.size
+		|| !(n = wt->wds.data[e->wd]) || !*e->name
+		|| is_output(wt->mi, e->name, n == wt->root)
+		|| ((p = later_page(e->name)) && p <= written(wt->mi, n->hash)))
+		return;
+	mark(n);
+	/* the rules go all the way down */
+	if(!strcmp(e->name, ignore_file)) { mark_all(n->child); return; }
+	/* the description of a directory is also on the page of it's parent, and
+	 it's sub-directories, through .. */
+	if(strcmp(e->name, html_desc)) return;
+	if(n->parent) mark(n->parent);
+	for(c = n->child; c; c = c->next) mark(c);
+}
+
+/** Renders `n` again, if it's dirty, and then the ones under it that are;
+ it's `dir` in `parent`, (both null for the root.) The sub-directories of a
+ dirty one are found again, and the new ones are rendered all the way down.
+ The index is written after, with the totals of all the sub-directories. */
+static void refresh(struct watcher *const wt, struct node *const n,
+	struct Files *const parent, const struct File *const dir) {
+	struct job *const job = &wt->job;
+	struct node *old, **tail, **prev, *c;
+	struct Files *f;
+	const char *name;
+	const int is_dirty = n->dirty;
+	double elapsed = 0.0;
+	if(!n->dirty && !n->below) return;
+	n->dirty = n->below = 0;
+	/* only what's rendered has news */
+	job->node = is_dirty ? n : 0;
+	job->is_news = is_dirty;
+	if(is_dirty) {
+		free(n->site.end), n->site.end = 0, n->site.buf = 0;
+		n->news.size = 0;
+		TextClear(job->site);
+		f = directory(parent, dir, job, &elapsed);
+		if(!keep(job, &n->site)) perror("site");
+	} else {
+		f = Files(wt->mi->fd, parent, dir, job->batch, job->stats, &filter,
+			job);
+	}
+	if(!f) { perror(*n->path ? n->path : dir_current); return; }
+	if(is_dirty) {
+		for(old = n->child, n->child = 0, tail = &n->child;
+			FilesAdvance(f); ) {
+			if(!is_subdirectory(f)) continue;
+			name = FilesName(f);
+			for(prev = &old; (c = *prev) && !is_named(c, name);
+				prev = &c->next);
+			if(c) *prev = c->next;
+			else if(!(c = node(wt, n, name))) { perror(name); continue; }
+			c->next = 0, *tail = c, tail = &c->next;
+			refresh(wt, c, f, FilesThis(f));
+			FilesSetTotal(f, FilesThis(f), &c->total);
+		}
+		while((c = old)) old = c->next, node_(wt, c);
+	} else {
+		/* they're in the same order; the clean ones have the same total */
+		for(old = n->child; FilesAdvance(f); ) {
+			if(!old || !is_subdirectory(f)) continue;
+			for(c = old, name = FilesName(f); c && !is_named(c, name);
+				c = c->next);
+			if(!c) continue;
+			refresh(wt, c, f, FilesThis(f));
+			FilesSetTotal(f, FilesThis(f), &c->total);
+			old = c->next;
+		}
+	}
+	finish(f, job, elapsed, &n->total);
+	Files_(f);
+}
+
+/** Puts the aggregates of `n` and everything under it into the streams of
+ `mi`. */
+static void site(struct MakeIndex *const mi, const struct node *n) {
+	for( ; n; n = n->next) fragment(mi, &n->site), site(mi, n->child);
+}
+
+/** Offers the news of `n` and everything under it to the feed of `mi`.
+ @return Success. */
+static int gather(struct MakeIndex *const mi, const struct node *n) {
+	size_t i;
+	for( ; n; n = n->next) {
+		for(i = 0; i < n->news.size; i++)
+			if(!FeedAdd(mi->feed, n->news.data + i)) return 0;
+		if(!gather(mi, n->child)) return 0;
+	}
+	return 1;
+}
+
+/** Renders the directories that changed, and then all of the aggregates
+ from what's kept. @return Success. */
+static int cycle(struct watcher *const wt) {
+	struct MakeIndex *const mi = wt->mi;
+	if(!WidgetSetNow(&mi->now)) { mi->why = "SOURCE_DATE_EPOCH"; return 0; }
+	refresh(wt, wt->root, 0, 0);
+	if(has_news(mi)) {
+		Feed_(&mi->feed);
+		if(!(mi->feed = Feed(mi->option.news ? mi->option.news : news_max)))
+			{ mi->why = "news"; return 0; }
+		if(!gather(mi, wt->root)) perror("news");
+	}
+	if(!streams_begin(mi)) return 0;
+	site(mi, wt->root);
+	streams_end(mi);
+	if(mi->snapshot && !SnapshotWrite(mi->snapshot)) perror(snapshot_file);
+	return 1;
+}
+
+/** Builds everything in `mi` on this thread, and then stays, building again
+ only the directories that change, until `stop` is set, which is looked at
+ after every change, and when a signal comes. @return Success; the reason is
+ on `stderr`. */
+int MakeIndexWatch(struct MakeIndex *const mi,
+	const volatile sig_atomic_t *const stop) {
+	struct watcher wt;
+	struct WatchEvent e;
+	int ready, timeout, success = 0;
+	assert(mi && stop);
+	wt.mi = mi;
+	wt.root = 0;
+	wt.wds.data = 0, wt.wds.size = 0;
+	job(mi, &wt.job);
+	wt.job.stats = mi->stats;
+	if(!(wt.watch = Watch())) { mi->why = "inotify"; goto finally; }
+	if(!(wt.job.page = Text()) || !(wt.job.site = Text()) || mi->stream.size
+		&& !(wt.job.end = malloc(sizeof *wt.job.end * mi->stream.size))
+		|| mi->option.gzip && !(wt.job.gz = Text()))
+		{ mi->why = "page"; goto finally; }
+	wt.job.batch = batch(mi);
+	if(!start(mi)) goto finally;
+	if(!(wt.root = node(&wt, 0, ""))) { mi->why = "watch"; goto finally; }
+	mi->publish = 1;
+	if(!cycle(&wt)) goto finally;
+	fprintf(stderr, "MakeIndex: watching for changes.\n");
+	while(!*stop) {
+		/* wait for something, and then for it to be quiet */
+		for(timeout = -1; (ready = WatchNext(wt.watch, timeout, &e)) > 0;
+			timeout = watch_debounce) touched(&wt, &e);
+		if(ready < 0) {
+			if(errno == EINTR) continue;
+			mi->why = "inotify"; goto finally;
+		}
+		if(!cycle(&wt)) goto finally;
+	}
+	success = 1;
+finally:
+	if(!success) perror(mi->why);
+	mi->publish = 0;
+	streams_end(mi);
+	node_(&wt, wt.root);
+	free(wt.wds.data);
+	Batch_(&wt.job.batch);
+	Text_(&wt.job.gz);
+	free(wt.job.end);
+	Text_(&wt.job.site);
+	Text_(&wt.job.page);
+	Watch_(&wt.watch);
+	return success;
+}
+
+/** Writes where the time went in `mi`, with `stats`, over all the calls, to
+ `fp`, as JSON. @return Success; without `stats`, there's nothing to write.
+ @throws[malloc, fprintf] */
+int MakeIndexReport(const struct MakeIndex *const mi, FILE *const fp) {
+	assert(mi && fp);
+	return !mi->stats || StatsReport(mi->stats, fp);
+}
+
+/** Writes what every widget in the templates of `mi`, with `profile`, came
+ to over all the calls, to `fp`, by template and line, slowest first.
+ @return Success; without `profile`, there's nothing to write.
+ @throws[malloc, fprintf] */
+int MakeIndexProfile(const struct MakeIndex *const mi, FILE *const fp) {
+	size_t i;
+	assert(mi && fp);
+	if(mi->index.parser
+		&& !ParserReport(mi->index.parser, template_index, fp)) return 0;
+	for(i = 0; i < mi->each.size; i++) if(!ParserReport(mi->each.data[i].parser,
+		mi->each.data[i].file, fp)) return 0;
+	for(i = 0; i < mi->stream.size; i++) if(!ParserReport(
+		mi->stream.data[i].t.parser, mi->stream.data[i].t.file, fp)) return 0;
+	return 1;
+}
+
+/** Writes the templates of `mi` as C to `fp`, to be built into a programme
+ that runs them without interpreting, (`make aot`.) @return Success.
+ @throws[fprintf] */
+int MakeIndexCompile(const struct MakeIndex *const mi, FILE *const fp) {
+	const struct Parser **p;
+	size_t i, n = 0;
+	int success;
+	assert(mi && fp);
+	if(!(p = malloc(sizeof *p * (1 + mi->each.size + mi->stream.size))))
+		return 0;
+	p[n++] = mi->index.parser;
+	for(i = 0; i < mi->each.size; i++) p[n++] = mi->each.data[i].parser;
+	for(i = 0; i < mi->stream.size; i++) p[n++] = mi->stream.data[i].t.parser;
+	success = ParserCompile(p, n, fp);
+	free(p);
+	return success;
 }
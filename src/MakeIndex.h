@@ -0,0 +1,34 @@
+#include <stddef.h> /* size_t */
+#include <stdio.h>  /* FILE */
+#include <signal.h> /* sig_atomic_t */
+
+/** What a <fn:MakeIndex> does; all zero is the default. */
+struct MakeIndexOptions {
+	int incremental; /* only the pages whose inputs changed are written */
+	int uring; /* directories are read in one batch, if the system has it */
+	int gzip; /* there is also a compressed sibling of every output */
+	int verbose; /* every directory is on `stderr` */
+	int stats; /* where the time went, for <fn:MakeIndexReport> */
+	int profile; /* what the widgets cost, for <fn:MakeIndexProfile> */
+	unsigned threads; /* more than one is in parallel */
+	size_t news; /* the items in the newsfeed, or zero for the default */
+	size_t page; /* files on a page of an index, or zero for all on one */
+	size_t cache; /* listings kept for rendering, or zero for the default */
+	const char *output; /* where the outputs go, or null for in the tree */
+};
+
+struct MakeIndex;
+
+struct MakeIndex *MakeIndex(const char *const root,
+	const struct MakeIndexOptions *const options);
+void MakeIndex_(struct MakeIndex **const mi_ptr);
+int MakeIndexBuild(struct MakeIndex *const mi);
+const char *MakeIndexRender(struct MakeIndex *const mi, const char *const dir,
+	const size_t page, size_t *const size);
+int MakeIndexWatch(struct MakeIndex *const mi,
+	const volatile sig_atomic_t *const stop);
+int MakeIndexServe(struct MakeIndex *const mi, const char *const address,
+	const volatile sig_atomic_t *const stop);
+int MakeIndexReport(const struct MakeIndex *const mi, FILE *const fp);
+int MakeIndexProfile(const struct MakeIndex *const mi, FILE *const fp);
+int MakeIndexCompile(const struct MakeIndex *const mi, FILE *const fp);
@@ -4,8 +4,9 @@
  @title Parser
  @author Neil
 
- Parsing of strings. '~' on a line by itself is recognized in ".newsfile.rss"
- and ".sitemap.xml" as a `<head>\~<body>\~<tail>`; there should be two of them.
+ Parsing of strings. '~' on a line by itself separates a template into
+ `<head>\~<body>\~<tail>`, like ".sitemap.xml" and ".newsfeed.rss"; there
+ should be two of them. <fn:ParserUses> says what a section has in it.
 
  Parsed in ".index.html",
 
@@ -16,17 +17,27 @@
  \* `@(pwd)\{}` prints the directory, the argument is the separator;
     _eg_, `@(pwd)\{/}`;
  \* `@(root)\{}`, like `@(pwd)`, except up instead of down;
- \* `@(now)` prints the date and the time in UTC.
+ \* `@(now)` prints the date and the time in UTC;
+ \* `@(page)` and `@(pages)` print which page of the index this is, and how
+	many, with `--page`;
+ \* `@(prev)\{}` and `@(next)\{}` go into the argument once if there's a page
+	before or after, which is `@(prevhref)` or `@(nexthref)`.
 
  Further parsed in `@(files){}` in ".index.html",
 
+ \* `@(dircount)` prints how many files are under a directory;
  \* `@(filealt) prints Dir or File;
  \* `@(filedesc);
  \* `@(filehref) prints the filename or the `.link`;
  \* `@(fileicon) prints it's `.d.jpeg`, or if it is not there, `dir.jpeg` or
 	 `file.jpeg`;
  \* `@(filename)` prints the file name;
- \* `@(filesize)` prints the file size, if it exits;
+ \* `@(filesize)` prints the file size, if it exits, or of everything under a
+	 directory;
+ \* `@(iconheight)` and `@(iconwidth)` print the size of `@(fileicon)` in
+	 pixels, if it's a PNG or a JPEG;
+ \* `@(lastmod)` prints the date the file was modified, or the newest under a
+	 directory;
  \* `@(now)` prints the date and the time in UTC.
 
  Parsed in ".newsfeed.rss",
@@ -37,63 +48,123 @@
  \* `@(now)` prints the date and the time in UTC;
  \* `@(title)` prints the second line in the {.news}.
 
- @std C89/90 */
+ The template is compiled once into a flat program of literal spans, widgets,
+ with their handlers already looked up, and loops, `@(widget)\{...}`, which
+ jump back to the widget while it returns true. The sections between `~` are
+ entry points. Rendering just runs the program; the template is never looked
+ at again, but the literals point into it, so it must stay.
+
+ The program can also be written out as C, <fn:ParserCompile>, where the
+ literals are spans of the template in a constant array and the widgets are
+ called directly. Built with `PARSER_COMPILED` and linked with that, (`make
+ aot`,) a template that's the same as one that was compiled runs that instead;
+ any other is interpreted, as usual.
+
+ With <fn:ParserProfile>, every call to a widget is counted and timed, with
+ what it wrote, by where it is in the template, for <fn:ParserReport>; it's
+ always interpreted, then.
+
+ @std POSIX.1-2008 */
 
-#include <stdio.h>  /* [f]printf FILE */
-#include <stdlib.h> /* malloc */
-#include <string.h> /* strstr, strpbrk */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>  /* fprintf FILE */
+#include <stdlib.h> /* malloc calloc realloc free qsort */
+#include <string.h> /* strncmp strlen strpbrk memcmp */
+#include <time.h>   /* clock_gettime */
+#include <errno.h>
+#include <pthread.h>
 #include <assert.h>
 #include "Widget.h"
 #include "Parser.h"
+#include "Text.h"
 
 /* private */
 static const int maxRecursion = 16;
+static const size_t no_loop = (size_t)-1;
+
+/* An instruction. `Literal` writes `text`; `Widget` calls `handler` until
+ it returns false; `Loop` calls `handler` and either goes on, or, if false, goes
+ past `jump`, which is the `End`; `End` goes back to `jump`, the `Loop`. */
+struct Op {
+	enum { Literal, Widget, Loop, End } code;
+	const char *text;
+	size_t length;
+	ParserWidget handler;
+	size_t jump;
+};
+
+/* What the calls to the handler of an `Op` came to. */
+struct Count { unsigned long calls, bytes; double seconds; };
+
+/* A `Count` for every `Op`, shared by the threads. */
+struct Profile {
+	pthread_mutex_t lock;
+	struct Count *count;
+};
 
 /* public */
 struct Parser {
-	char *str;
-	char *pos;
-	char *rew;
-	int  recursion;
+	const char *str; /* the template */
+	struct { struct Op *data; size_t size, capacity; } op;
+	struct { size_t *data; size_t size, capacity; } section; /* starts */
+	const struct ParserCompiled *compiled; /* ahead of time, or null */
+	struct Profile *profile; /* with <fn:ParserProfile>, or null */
 };
 /* private - this is the list of 'widgets', see Widget.c - add widgets to here
- to make them recognised - ASCIIbetical */
+ to make them recognised - ASCIIbetical; the name of the handler is for
+ <fn:ParserCompile> */
+#define WIDGET(symbol, handler, root) { symbol, &handler, #handler, root }
 static const struct Symbol {
 	const char *const symbol;
 	const ParserWidget handler;
+	const char *const name;
 	const int onlyInRoot; /* fixme: not used, just trust the users? haha */
 } sym[] = {
-	{ "content",  &WidgetContent,  0 },  /* index */
-	{ "date",     &WidgetDate,     0 },  /* news */
-	{ "filealt",  &WidgetFilealt,  0 },  /* files */
-	{ "filedesc", &WidgetFiledesc, 0 },  /* files */
-	{ "filehref", &WidgetFilehref, 0 },  /* files */
-	{ "fileicon", &WidgetFileicon, 0 },  /* files */
-	{ "filename", &WidgetFilename, 0 },  /* files */
-	{ "files",    &WidgetFiles,    -1 }, /* index */
-	{ "filesize", &WidgetFilesize, 0 },  /* files */
+	WIDGET("content",  WidgetContent,  0),  /* index */
+	WIDGET("date",     WidgetDate,     0),  /* news */
+	WIDGET("dircount", WidgetDircount, 0),  /* files */
+	WIDGET("filealt",  WidgetFilealt,  0),  /* files */
+	WIDGET("filedesc", WidgetFiledesc, 0),  /* files */
+	WIDGET("filehref", WidgetFilehref, 0),  /* files */
+	WIDGET("fileicon", WidgetFileicon, 0),  /* files */
+	WIDGET("filename", WidgetFilename, 0),  /* files */
+	WIDGET("files",    WidgetFiles,    -1), /* index */
+	WIDGET("filesize", WidgetFilesize, 0),  /* files */
 	/*{ "folder",   0,               -1 }, *//* replaced by ~ - scetchy */
-	{ "htmlcontent",&WidgetContent,0 },  /* index */
-	{ "news",     &WidgetNews,     0 },  /* news */
-	{ "newsname", &WidgetNewsname, 0 },  /* news */
-	{ "now",      &WidgetNow,      0 },  /* any */
-	{ "pwd",      &WidgetPwd,      -1 }, /* index */
-	{ "root",     &WidgetRoot,     -1 }, /* like pwd except up instead of dn */
-	{ "title",    &WidgetTitle,    0 }   /* news */
+	WIDGET("htmlcontent", WidgetContent, 0), /* index */
+	WIDGET("iconheight", WidgetIconheight, 0), /* files */
+	WIDGET("iconwidth", WidgetIconwidth, 0), /* files */
+	WIDGET("lastmod",  WidgetLastmod,  0),  /* files */
+	WIDGET("news",     WidgetNews,     0),  /* news */
+	WIDGET("newsname", WidgetNewsname, 0),  /* news */
+	WIDGET("next",     WidgetNext,     -1), /* index */
+	WIDGET("nexthref", WidgetNexthref, -1), /* index */
+	WIDGET("now",      WidgetNow,      0),  /* any */
+	WIDGET("page",     WidgetPage,     -1), /* index */
+	WIDGET("pages",    WidgetPages,    -1), /* index */
+	WIDGET("prev",     WidgetPrev,     -1), /* index */
+	WIDGET("prevhref", WidgetPrevhref, -1), /* index */
+	WIDGET("pwd",      WidgetPwd,      -1), /* index */
+	WIDGET("root",     WidgetRoot,     -1), /* like pwd except up instead of dn */
+	WIDGET("title",    WidgetTitle,    0)   /* news */
 };
+#undef WIDGET
+
+#ifndef PARSER_COMPILED /* otherwise, they're in the generated file */
+const struct ParserCompiled parser_compiled[1] = { { 0, 0, 0, 0 } };
+const size_t parser_compiled_size = 0;
+#endif
 
 /** Binary search of `str` -- `end` in symbol table. */
 static const struct Symbol *match(const char *str, const char *end) {
 	const int n = sizeof sym / sizeof *sym; /* global symbol table */
 	int a, lo = 0, mid, hi = n - 1;
-	size_t lenMatch = (size_t)(end - str), lenComp;
+	const size_t length = (size_t)(end - str);
 	assert(str <= end);
 	while(lo <= hi) {
 		mid = (lo + hi) >> 1;
-		/* this is highly inefficient */
-		lenComp = strlen(sym[mid].symbol);
-		a = strncmp(str, sym[mid].symbol,
-			lenMatch > lenComp ? lenMatch : lenComp);
+		if(!(a = strncmp(str, sym[mid].symbol, length))
+			&& sym[mid].symbol[length]) a = -1; /* a prefix is less */
 		if     (a < 0) hi = mid - 1;
 		else if(a > 0) lo = mid + 1;
 		else           return &sym[mid];
@@ -101,89 +172,414 @@ static const struct Symbol *match(const char *str, const char *end) {
 	return 0;
 }
 
-/** @return Creates a parser for the string, `str`. */
-struct Parser *Parser(char *const str) {
+/** @return A new instruction at the end of `p` or null. @throws[realloc] */
+static struct Op *op(struct Parser *const p) {
+	if(p->op.size >= p->op.capacity) {
+		size_t c = p->op.capacity ? p->op.capacity << 1 : 32;
+		struct Op *data;
+		if(!(data = realloc(p->op.data, c * sizeof *data))) return 0;
+		p->op.data = data, p->op.capacity = c;
+	}
+	return p->op.data + p->op.size++;
+}
+
+/** Starts a new section at the current end of `p`. @return Success.
+ @throws[realloc] */
+static int section(struct Parser *const p) {
+	if(p->section.size >= p->section.capacity) {
+		size_t c = p->section.capacity ? p->section.capacity << 1 : 4;
+		size_t *data;
+		if(!(data = realloc(p->section.data, c * sizeof *data))) return 0;
+		p->section.data = data, p->section.capacity = c;
+	}
+	p->section.data[p->section.size++] = p->op.size;
+	return 1;
+}
+
+/** Appends the literal `[a, b)` to `p`. @return Success. @throws[realloc] */
+static int text(struct Parser *const p, const char *const a,
+	const char *const b) {
+	struct Op *o;
+	assert(a <= b);
+	if(a == b) return 1;
+	if(!(o = op(p))) return 0;
+	o->code = Literal, o->text = a, o->length = (size_t)(b - a);
+	o->handler = 0, o->jump = 0;
+	return 1;
+}
+
+/** Looks for the template of `p` in what was compiled ahead of time; it has to
+ be exactly the same. */
+static void compiled(struct Parser *const p) {
+	const struct ParserCompiled *c;
+	const size_t size = strlen(p->str);
+	size_t i;
+	for(i = 0; i < parser_compiled_size; i++) {
+		c = parser_compiled + i;
+		if(c->size != size || c->sections != p->section.size
+			|| memcmp(c->str, p->str, size)) continue;
+		p->compiled = c;
+		break;
+	}
+}
+
+/** @return Compiles the template string, `str`, into a parser, or null. The
+ string must outlive the parser. @throws[malloc, realloc] */
+struct Parser *Parser(const char *const str) {
 	struct Parser *p;
-	if(!(p = malloc(sizeof *p))) return 0;
-	p->str       = str;
-	p->pos       = p->str;
-	p->rew       = p->str;
-	p->recursion = 0;
+	struct Op *o;
+	const char *pos = str, *mark = str;
+	size_t open = no_loop; /* the innermost `Loop`, chained through `jump` */
+	int depth = 0;
+	if(!str || !(p = malloc(sizeof *p))) return 0;
+	p->str = str;
+	p->op.data = 0, p->op.size = p->op.capacity = 0;
+	p->section.data = 0, p->section.size = p->section.capacity = 0;
+	p->compiled = 0;
+	p->profile = 0;
+	if(!section(p)) goto catch;
+	for( ; ; ) {
+		if(!(pos = strpbrk(pos, "@}~"))) {
+			if(!text(p, mark, mark + strlen(mark))) goto catch;
+			break;
+		} else if(*pos == '}') {
+			if(!depth) { pos++; continue; } /* just a brace */
+			if(!text(p, mark, pos) || !(o = op(p))) goto catch;
+			o->code = End, o->text = 0, o->length = 0, o->handler = 0;
+			o->jump = open;
+			open = p->op.data[open].jump;
+			p->op.data[o->jump].jump = p->op.size - 1;
+			depth--;
+			mark = ++pos;
+		} else if(*pos == '~') {
+			/* a tilde on a line by itself */
+			if(!depth && (pos == str || pos[-1] == '\n') && pos[1] == '\n') {
+				if(!text(p, mark, pos) || !section(p)) goto catch;
+				mark = pos += 2; /* "~\n" */
+			} else {
+				pos++;
+			}
+		} else if(pos[1] == '(') { /* the only one left is @ */
+			const struct Symbol *m;
+			const char *const start = pos + 2, *end;
+			if(!text(p, mark, pos)) goto catch;
+			if(!(end = strpbrk(start, ")"))) { /* syntax error */
+				fprintf(stderr, "Parser: unclosed '@(' in template.\n");
+				mark = pos + strlen(pos);
+				break;
+			}
+			if(!(m = match(start, end))) fprintf(stderr,
+				"Parser: symbol not reconised, '%.*s.'\n",
+				(int)(end - start), start);
+			if(end[1] == '{') {
+				if(!(o = op(p))) goto catch;
+				o->code = Loop, o->text = start;
+				o->length = (size_t)(end - start);
+				o->handler = m ? m->handler : 0;
+				o->jump = open, open = p->op.size - 1;
+				if(++depth > maxRecursion) fprintf(stderr, "Parser: %d "
+					"levels of @(...){...} reached.\n", depth);
+				mark = pos = end + 2;
+			} else {
+				if(m && m->handler) {
+					if(!(o = op(p))) goto catch;
+					o->code = Widget, o->text = start;
+					o->length = (size_t)(end - start);
+					o->handler = m->handler, o->jump = 0;
+				}
+				mark = pos = end + 1;
+			}
+		} else { /* @ by itself */
+			pos++;
+		}
+	}
+	if(depth) {
+		fprintf(stderr, "Parser: %d unclosed '{' in template.\n", depth);
+		while(open != no_loop) { /* close them at the end */
+			if(!(o = op(p))) goto catch;
+			o->code = End, o->text = 0, o->length = 0, o->handler = 0;
+			o->jump = open;
+			open = p->op.data[open].jump;
+			p->op.data[o->jump].jump = p->op.size - 1;
+		}
+	}
+	compiled(p);
 	return p;
+catch:
+	Parser_(&p);
+	return 0;
 }
 
 /** @param[p_ptr] A pointer to the `Parser` that's to be destucted. */
 void Parser_(struct Parser **const p_ptr) {
 	struct Parser *p;
 	if(!p_ptr || !(p = *p_ptr)) return;
-	if(p->recursion) fprintf(stderr, "Parser~: a file was closed with "
-		"recursion level of %d; syntax error?\n", p->recursion);
+	if(p->profile) {
+		pthread_mutex_destroy(&p->profile->lock);
+		free(p->profile->count);
+		free(p->profile);
+	}
+	free(p->op.data);
+	free(p->section.data);
 	free(p);
 	*p_ptr = 0;
 }
 
-/** Resets the parser, `p`. */
-void ParserRewind(struct Parser *p) {
-	if(!p) return;
-	p->pos = p->rew;
+/** @return The number of sections separated by `~` in `p`. */
+size_t ParserSections(const struct Parser *const p) {
+	return p ? p->section.size : 0;
+}
+
+/** @return Whether `section` of `p` has the widget `handler`. */
+int ParserUses(const struct Parser *const p, const size_t section,
+	const ParserWidget handler) {
+	size_t i, end;
+	if(!p || section >= p->section.size) return 0;
+	end = section + 1 < p->section.size
+		? p->section.data[section + 1] : p->op.size;
+	for(i = p->section.data[section]; i < end; i++) {
+		const struct Op *const op = p->op.data + i;
+		if((op->code == Widget || op->code == Loop)
+			&& op->handler == handler) return 1;
+	}
+	return 0;
+}
+
+/** Counts every call to a widget in `p` from now on, for <fn:ParserReport>.
+ @return Success. @throws[malloc, calloc, pthread_mutex_init] */
+int ParserProfile(struct Parser *const p) {
+	struct Profile *pr;
+	int e;
+	assert(p);
+	if(p->profile) return 1;
+	if(!(pr = malloc(sizeof *pr))) return 0;
+	if(!(pr->count = calloc(p->op.size ? p->op.size : 1, sizeof *pr->count)))
+		{ free(pr); return 0; }
+	if((e = pthread_mutex_init(&pr->lock, 0)))
+		{ free(pr->count); free(pr); errno = e; return 0; }
+	p->profile = pr;
+	return 1;
+}
+
+/** @return Seconds on a clock that doesn't go back. */
+static double now(void) {
+	struct timespec ts;
+	if(clock_gettime(CLOCK_MONOTONIC, &ts)) return 0.0;
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
 }
 
-/** Parse, called recursively.
+/** Calls the handler of the `i`th `Op` of `p` once, and, with a profile,
+ counts it. @return What the handler did. */
+static int call(const struct Parser *const p, const size_t i,
+	struct Text *const out, struct Files *const f, struct Widget *const w) {
+	const struct Op *const o = p->op.data + i;
+	struct Count *c;
+	size_t size;
+	double t;
+	int ret;
+	if(!p->profile) return o->handler(f, out, w);
+	size = TextSize(out), t = now();
+	ret = o->handler(f, out, w);
+	t = now() - t;
+	pthread_mutex_lock(&p->profile->lock);
+	c = p->profile->count + i;
+	c->calls++, c->bytes += (unsigned long)(TextSize(out) - size);
+	c->seconds += t;
+	pthread_mutex_unlock(&p->profile->lock);
+	return ret;
+}
+
+/** Renders a section of `p`; the parser is not modified, except for the
+ profile, which is locked, so it can be used on different threads at once.
+ @param[section] The section; `~` on a line by itself separates them.
+ @param[out] Output; it is appended to.
  @param[f] Called in the handler to `ParserWidget`.
- @param[invisible] Binary -- no output.
- @param[fp] Output.
- @fixme This fn needs rewriting; messy.
- @fixme Invisible, hack. */
-int ParserParse(struct Parser *p, FILE *fp,
-	struct Files *const f, int invisible) {
-	char *mark;
-	if(!p || !fp || !p->pos) return 0;
-	if(++p->recursion > maxRecursion) fprintf(stderr, "Parser::parse: %d "
-		"recursion levels reached (Ctrl-C to stop!)\n", p->recursion);
-	mark = p->pos;
-	if(p->recursion == 1) p->rew = mark;
-	for( ; ; ) {
-		p->pos = strpbrk(p->pos, "@}~");
-		if(!p->pos) {
-			if(!invisible) fprintf(fp, "%.*s", (int)(p->pos - mark), mark);
+ @param[w] The state of the widgets; also passed to the handler.
+ @return Whether there was such a section. */
+int ParserParse(const struct Parser *const p, const size_t section,
+	struct Text *const out, struct Files *const f, struct Widget *const w) {
+	const struct Op *o;
+	size_t i, end;
+	if(!p || !out || section >= p->section.size) return 0;
+	if(p->compiled && !p->profile)
+		{ p->compiled->section[section](out, f, w); return 1; }
+	i   = p->section.data[section];
+	end = section + 1 < p->section.size
+		? p->section.data[section + 1] : p->op.size;
+	while(i < end) {
+		switch((o = p->op.data + i)->code) {
+		case Literal:
+			TextCat(out, o->text, o->length);
+			i++;
 			break;
-		} else if(*p->pos == '}') {
-			if(!invisible) fprintf(fp, "%.*s", (int)(p->pos - mark), mark);
-			p->pos++;
+		case Widget:
+			while(call(p, i, out, f, w));
+			i++;
 			break;
-		} else if(*p->pos == '~') {
-			/* a tilde on a line by itself */
-			if(p->recursion == 1 &&
-			   ((p->pos <= p->str || *(p->pos - 1) == '\n') &&
-			   *(p->pos + 1) == '\n')) {
-				if(!invisible) fprintf(fp, "%.*s", (int)(p->pos - mark), mark);
-				p->pos += 2; /* "~\n" */
-				p->recursion = 0;
-				return 1;
+		case Loop:
+			i = o->handler && call(p, i, out, f, w) ? i + 1 : o->jump + 1;
+			break;
+		case End:
+			i = o->jump;
+			break;
+		}
+	}
+	return 1;
+}
+
+/* A line of <fn:ParserReport>: the widgets that are the same on a line. */
+struct Row { const struct Op *op; size_t line; struct Count count; };
+
+/** @implements qsort */
+static int row_cmp(const void *a, const void *b) {
+	const double x = ((const struct Row *)a)->count.seconds,
+		y = ((const struct Row *)b)->count.seconds;
+	return (x < y) - (x > y);
+}
+
+/** Writes what the widgets of `p` came to, since <fn:ParserProfile>, to
+ `fp`, slowest first, one line each, as `name:line: @(widget)`; the ones on
+ the same line with the same name are together, and the ones that were never
+ called aren't there. The time of a loop is only the widget, not what's in
+ it. @return Success; without a profile, there's nothing to write.
+ @throws[malloc, fprintf] */
+int ParserReport(const struct Parser *const p, const char *const name,
+	FILE *const fp) {
+	struct Row *row;
+	const struct Op *o;
+	const char *c;
+	size_t i, r, n = 0, line = 1;
+	assert(p && name && fp);
+	if(!p->profile) return 1;
+	if(!(row = malloc(sizeof *row * (p->op.size ? p->op.size : 1)))) return 0;
+	pthread_mutex_lock(&p->profile->lock);
+	for(i = 0, c = p->str; i < p->op.size; i++) {
+		const struct Count *const count = p->profile->count + i;
+		o = p->op.data + i;
+		if(o->code != Widget && o->code != Loop || !count->calls) continue;
+		/* the ops are in the order of the template */
+		for( ; c < o->text; c++) if(*c == '\n') line++;
+		for(r = 0; r < n && (row[r].line != line || row[r].op->length
+			!= o->length || memcmp(row[r].op->text, o->text, o->length));
+			r++);
+		if(r == n) {
+			row[n].op = o, row[n].line = line;
+			row[n].count.calls = row[n].count.bytes = 0;
+			row[n].count.seconds = 0.0;
+			n++;
+		}
+		row[r].count.calls += count->calls;
+		row[r].count.bytes += count->bytes;
+		row[r].count.seconds += count->seconds;
+	}
+	pthread_mutex_unlock(&p->profile->lock);
+	qsort(row, n, sizeof *row, &row_cmp);
+	for(r = 0; r < n; r++) fprintf(fp, "%s:%lu: @(%.*s) %lu calls, %lu bytes, "
+		"%.6f seconds\n", name, (unsigned long)row[r].line,
+		(int)row[r].op->length, row[r].op->text, row[r].count.calls,
+		row[r].count.bytes, row[r].count.seconds);
+	free(row);
+	return !ferror(fp);
+}
+
+/** @return The name of the handler `h`, for C. */
+static const char *handler_name(const ParserWidget h) {
+	size_t i;
+	for(i = 0; i < sizeof sym / sizeof *sym; i++)
+		if(sym[i].handler == h) return sym[i].name;
+	assert(0);
+	return "0";
+}
+
+/** Writes `p`, the `n`th template, as C to `fp`: the template in an array,
+ and a function for every section. @return Success.
+ @throws[fprintf, fputc] */
+static int compile(const struct Parser *const p, const size_t n,
+	FILE *const fp) {
+	const size_t size = strlen(p->str);
+	const struct Op *o;
+	size_t i, s, end, depth, t;
+	/* the literals are spans of this */
+	if(fprintf(fp, "static const char template%lu[] = {", (unsigned long)n)
+		< 0) return 0;
+	for(i = 0; i <= size; i++) if(fprintf(fp, "%s%d,", i % 12 ? " " : "\n\t",
+		(int)(unsigned char)p->str[i]) < 0) return 0;
+	if(fprintf(fp, "\n};\n") < 0) return 0;
+	for(s = 0; s < p->section.size; s++) {
+		i = p->section.data[s];
+		end = s + 1 < p->section.size ? p->section.data[s + 1] : p->op.size;
+		if(fprintf(fp, "static void template%lu_%lu(struct Text *const out,\n"
+			"\tstruct Files *const f, struct Widget *const w) {\n"
+			"\t(void)out, (void)f, (void)w;\n",
+			(unsigned long)n, (unsigned long)s) < 0) return 0;
+		for(depth = 1; i < end; ) {
+			o = p->op.data + i;
+			for(t = o->code == End ? 1 : 0; t < depth; t++)
+				if(fputc('\t', fp) == EOF) return 0;
+			switch(o->code) {
+			case Literal:
+				if(fprintf(fp, "TextCat(out, template%lu + %lu, %lu);\n",
+					(unsigned long)n, (unsigned long)(o->text - p->str),
+					(unsigned long)o->length) < 0) return 0;
+				i++;
+				break;
+			case Widget:
+				if(fprintf(fp, "while(%s(f, out, w));\n",
+					handler_name(o->handler)) < 0) return 0;
+				i++;
+				break;
+			case Loop:
+				/* not recognised, so it's never entered */
+				if(!o->handler) {
+					if(fprintf(fp, "/* @(%.*s) */\n", (int)o->length, o->text)
+						< 0) return 0;
+					i = o->jump + 1;
+					break;
+				}
+				if(fprintf(fp, "while(%s(f, out, w)) {\n",
+					handler_name(o->handler)) < 0) return 0;
+				depth++, i++;
+				break;
+			case End:
+				if(fprintf(fp, "}\n") < 0) return 0;
+				depth--, i++;
+				break;
 			}
-			p->pos++;
-		} else if(*(p->pos + 1) == '(') { /* the only one left is @ */
-			const struct Symbol *m;
-			int                 over = 0, open;
-			char                *start = p->pos + 2, *end;
-			if(!invisible) fprintf(fp, "%.*s", (int)(p->pos - mark), mark);
-			if(!(end = strpbrk(start, ")"))) break; /* syntax error */
-			if(!(m = match(start, end))) fprintf(stderr,
-				"Parser::parse: symbol not reconised, '%.*s.'\n",
-				(int)(end - start), start);
-			open = *(end + 1) == '{' ? -1 : 0;
-			do {
-				/* -> widget.c */
-				if(m && m->handler && !invisible) over = m->handler(f, fp);
-				p->pos = end + (open ? 2 : 1);
-				/* recurse between {} */
-				if(open) ParserParse(p, fp, f, invisible || !over);
-			} while(over);
-			mark = p->pos;
-		} else { /* @ by itself */
-			p->pos++;
 		}
+		if(fprintf(fp, "}\n") < 0) return 0;
 	}
-	p->recursion--;
-	return 0;
+	if(fprintf(fp, "static const ParserSection template%lu_sections[] = {",
+		(unsigned long)n) < 0) return 0;
+	for(s = 0; s < p->section.size; s++) if(fprintf(fp, "%s&template%lu_%lu",
+		s ? ", " : "", (unsigned long)n, (unsigned long)s) < 0) return 0;
+	return fprintf(fp, "};\n") >= 0;
+}
+
+/** Writes the `n` templates of `p` as a C translation unit to `fp`, that
+ defines `parser_compiled`, to be linked with this built with
+ `PARSER_COMPILED`. Null parsers are skipped. @return Success.
+ @throws[fprintf] */
+int ParserCompile(const struct Parser *const *const p, const size_t n,
+	FILE *const fp) {
+	size_t i, count = 0;
+	assert(p && fp);
+	if(fprintf(fp, "/* Generated by ParserCompile; the templates that this is "
+		"used for are\n exactly these. */\n\n"
+		"#include <stdio.h>\n#include \"Parser.h\"\n#include \"Text.h\"\n"
+		"#include \"Widget.h\"\n\n") < 0) return 0;
+	for(i = 0; i < n; i++) if(p[i] && !compile(p[i], i, fp)) return 0;
+	if(fprintf(fp, "\nconst struct ParserCompiled parser_compiled[] = {\n")
+		< 0) return 0;
+	for(i = 0; i < n; i++) {
+		if(!p[i]) continue;
+		if(fprintf(fp, "\t{ template%lu, %lu, %lu, template%lu_sections },\n",
+			(unsigned long)i, (unsigned long)strlen(p[i]->str),
+			(unsigned long)p[i]->section.size, (unsigned long)i) < 0)
+			return 0;
+		count++;
+	}
+	/* there has to be at least one */
+	if(!count && fprintf(fp, "\t{ 0, 0, 0, 0 }\n") < 0) return 0;
+	return fprintf(fp, "};\nconst size_t parser_compiled_size = %lu;\n",
+		(unsigned long)count) >= 0;
 }
@@ -1,11 +1,38 @@
 struct Parser;
 struct Files;
+struct Widget;
+struct Text;
 
 /* All `ParserWidget` are in `Widget.c`. */
-typedef int (*ParserWidget)(struct Files *const files, FILE *const fp);
+typedef int (*ParserWidget)(struct Files *const files,
+	struct Text *const out, struct Widget *const w);
 
-struct Parser *Parser(char *const str);
+/* A section of a template that was compiled ahead of time. */
+typedef void (*ParserSection)(struct Text *const out, struct Files *const f,
+	struct Widget *const w);
+
+/** A template, `str`, that was compiled ahead of time by
+ <fn:ParserCompile>, and it's `sections`. */
+struct ParserCompiled {
+	const char *str;
+	size_t size, sections;
+	const ParserSection *section;
+};
+
+/* In `Parser.c`, or the file from <fn:ParserCompile> with
+ `PARSER_COMPILED`. */
+extern const struct ParserCompiled parser_compiled[];
+extern const size_t parser_compiled_size;
+
+struct Parser *Parser(const char *const str);
 void Parser_(struct Parser **const p_ptr);
-void ParserRewind(struct Parser *p);
-int ParserParse(struct Parser *p, FILE *fp,
-struct Files *const f, int invisible);
+size_t ParserSections(const struct Parser *const p);
+int ParserUses(const struct Parser *const p, const size_t section,
+	const ParserWidget handler);
+int ParserParse(const struct Parser *const p, const size_t section,
+	struct Text *const out, struct Files *const f, struct Widget *const w);
+int ParserProfile(struct Parser *const p);
+int ParserReport(const struct Parser *const p, const char *const name,
+	FILE *const fp);
+int ParserCompile(const struct Parser *const *const p, const size_t n,
+	FILE *const fp);
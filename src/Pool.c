@@ -0,0 +1,190 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Pool
+ @author Neil
+
+ A work-stealing `Pool` of threads. Every worker has a deque of tasks; it
+ pushes and pops at the back, so it works depth-first on what it has just
+ found, and when it runs out, it steals from the front of the others, which
+ tends to be the biggest piece of work. The deques are each behind a mutex;
+ contention is only ever between a worker and a thief.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>  /* malloc realloc free */
+#include <stdio.h>   /* fprintf */
+#include <errno.h>
+#include <pthread.h>
+#include <assert.h>
+#include "Pool.h"
+
+struct Deque {
+	pthread_mutex_t lock;
+	void **task;
+	size_t front, back, capacity; /* `task[front, back)` */
+};
+
+/* public */
+struct Pool {
+	PoolTask run;
+	unsigned threads;
+	struct Deque *deque;
+	pthread_mutex_t lock;    /* protects the following */
+	pthread_cond_t wake;
+	size_t pending;          /* pushed but not finished */
+	unsigned long pushes;    /* so sleepers don't miss a push */
+	unsigned sleeping;
+};
+
+struct Worker { struct Pool *pool; unsigned no; };
+
+/** @return Creates a pool of `threads` that will call `run` on every task.
+ @throws[malloc, pthread_mutex_init, pthread_cond_init] */
+struct Pool *Pool(const unsigned threads, const PoolTask run) {
+	struct Pool *pool;
+	unsigned i;
+	assert(threads && run);
+	if(!(pool = malloc(sizeof *pool + threads * sizeof *pool->deque)))
+		return 0;
+	pool->run      = run;
+	pool->threads  = 0;
+	pool->deque    = (struct Deque *)(pool + 1);
+	pool->pending  = 0;
+	pool->pushes   = 0;
+	pool->sleeping = 0;
+	if((errno = pthread_mutex_init(&pool->lock, 0))) { free(pool); return 0; }
+	if((errno = pthread_cond_init(&pool->wake, 0)))
+		{ pthread_mutex_destroy(&pool->lock); free(pool); return 0; }
+	for(i = 0; i < threads; i++) {
+		struct Deque *const d = pool->deque + i;
+		if((errno = pthread_mutex_init(&d->lock, 0))) { Pool_(&pool); return 0; }
+		d->task = 0, d->front = d->back = d->capacity = 0;
+		pool->threads++;
+	}
+	return pool;
+}
+
+/** Destructor; the pool must not be running. */
+void Pool_(struct Pool **const pool_ptr) {
+	struct Pool *pool;
+	unsigned i;
+	if(!pool_ptr || !(pool = *pool_ptr)) return;
+	for(i = 0; i < pool->threads; i++) {
+		pthread_mutex_destroy(&pool->deque[i].lock);
+		free(pool->deque[i].task);
+	}
+	pthread_cond_destroy(&pool->wake);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool);
+	*pool_ptr = 0;
+}
+
+/** Adds `task` to the back of the deque of `worker`; before <fn:PoolRun>,
+ `worker` zero is fine. @return Success. @throws[realloc] */
+int PoolPush(struct Pool *const pool, const unsigned worker, void *const task) {
+	struct Deque *d;
+	assert(pool && worker < pool->threads && task);
+	d = pool->deque + worker;
+	/* count it before anyone can take it, or it could finish first */
+	pthread_mutex_lock(&pool->lock);
+	pool->pending++;
+	pthread_mutex_unlock(&pool->lock);
+	pthread_mutex_lock(&d->lock);
+	if(d->back >= d->capacity) {
+		if(d->front) { /* slide down what's left */
+			size_t i;
+			for(i = d->front; i < d->back; i++) d->task[i - d->front] = d->task[i];
+			d->back -= d->front, d->front = 0;
+		}
+		if(d->back >= d->capacity) {
+			size_t c = d->capacity ? d->capacity << 1 : 64;
+			void **t;
+			if(!(t = realloc(d->task, c * sizeof *t))) {
+				pthread_mutex_unlock(&d->lock);
+				pthread_mutex_lock(&pool->lock);
+				pool->pending--;
+				pthread_mutex_unlock(&pool->lock);
+				return 0;
+			}
+			d->task = t, d->capacity = c;
+		}
+	}
+	d->task[d->back++] = task;
+	pthread_mutex_unlock(&d->lock);
+	pthread_mutex_lock(&pool->lock);
+	pool->pushes++;
+	if(pool->sleeping) pthread_cond_signal(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	return 1;
+}
+
+/** @return A task from the back of `worker`'s own deque, or else the front of
+ someone else's, or null. */
+static void *take(struct Pool *const pool, const unsigned worker) {
+	struct Deque *d = pool->deque + worker;
+	void *task = 0;
+	unsigned i;
+	pthread_mutex_lock(&d->lock);
+	if(d->front < d->back) task = d->task[--d->back];
+	pthread_mutex_unlock(&d->lock);
+	for(i = 1; !task && i < pool->threads; i++) {
+		d = pool->deque + (worker + i) % pool->threads;
+		pthread_mutex_lock(&d->lock);
+		if(d->front < d->back) task = d->task[d->front++];
+		pthread_mutex_unlock(&d->lock);
+	}
+	return task;
+}
+
+/** Thread entry; runs tasks until there are no more anywhere. */
+static void *work(void *const param) {
+	struct Worker *const w = param;
+	struct Pool *const pool = w->pool;
+	unsigned long pushes;
+	void *task;
+	for( ; ; ) {
+		pthread_mutex_lock(&pool->lock);
+		pushes = pool->pushes;
+		pthread_mutex_unlock(&pool->lock);
+		if((task = take(pool, w->no))) {
+			pool->run(pool, w->no, task);
+			pthread_mutex_lock(&pool->lock);
+			if(!--pool->pending) pthread_cond_broadcast(&pool->wake);
+			pthread_mutex_unlock(&pool->lock);
+			continue;
+		}
+		/* nothing to steal; done if nothing is running, else wait */
+		pthread_mutex_lock(&pool->lock);
+		if(!pool->pending) { pthread_mutex_unlock(&pool->lock); break; }
+		if(pool->pushes != pushes) { pthread_mutex_unlock(&pool->lock); continue; }
+		pool->sleeping++;
+		pthread_cond_wait(&pool->wake, &pool->lock);
+		pool->sleeping--;
+		pthread_mutex_unlock(&pool->lock);
+	}
+	return 0;
+}
+
+/** Runs all the tasks that were pushed, and all that they push, on the
+ threads of `pool`, and waits for them to finish.
+ @return Success starting the threads. @throws[malloc, pthread_create] */
+int PoolRun(struct Pool *const pool) {
+	struct Worker *worker;
+	pthread_t *thread;
+	unsigned i, started;
+	assert(pool);
+	if(!(worker = malloc(pool->threads * (sizeof *worker + sizeof *thread))))
+		return 0;
+	thread = (pthread_t *)(worker + pool->threads);
+	for(i = 0; i < pool->threads; i++) worker[i].pool = pool, worker[i].no = i;
+	/* the calling thread is worker zero */
+	for(started = 1; started < pool->threads; started++)
+		if((errno = pthread_create(thread + started, 0, &work, worker + started)))
+		{ perror("Pool"); break; }
+	work(worker);
+	for(i = 1; i < started; i++) pthread_join(thread[i], 0);
+	free(worker);
+	return 1;
+}
@@ -0,0 +1,10 @@
+struct Pool;
+
+/** Runs `task` on `worker`, `[0, threads)`; it may <fn:PoolPush> more. */
+typedef void (*PoolTask)(struct Pool *const pool, const unsigned worker,
+	void *const task);
+
+struct Pool *Pool(const unsigned threads, const PoolTask run);
+void Pool_(struct Pool **const pool_ptr);
+int PoolPush(struct Pool *const pool, const unsigned worker, void *const task);
+int PoolRun(struct Pool *const pool);
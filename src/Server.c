@@ -0,0 +1,241 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Server
+ @author Neil
+
+ `Server` is just enough HTTP/1.0 to look at pages in a browser: one
+ connection at a time, on a Unix domain socket, or on a port of the loopback,
+ so it's never on the network. <fn:ServerNext> waits for a `GET` or `HEAD` and
+ gives it's path; <fn:ServerReply> answers it with a page and closes it.
+ Anything else is answered by itself, and a client that says nothing for a
+ while is dropped.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h> /* malloc free strtoul */
+#include <stdio.h>  /* sprintf */
+#include <string.h> /* strlen strchr memcmp */
+#include <errno.h>
+#include <unistd.h> /* read close unlink */
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/stat.h>    /* lstat */
+#include <sys/socket.h>
+#include <sys/un.h>      /* sockaddr_un */
+#include <netinet/in.h>  /* sockaddr_in htonl htons */
+#include <assert.h>
+#include "Server.h"
+
+#ifndef MSG_NOSIGNAL /* not in POSIX.1-2001; there's no SIGPIPE to stop */
+#define MSG_NOSIGNAL 0
+#endif
+
+/* constants */
+static const int client_timeout = 5000; /* milliseconds */
+static const int backlog = 16;
+
+struct Server {
+	int fd, client, is_head;
+	char *socket; /* on the file-system, to take away at the end */
+	char request[4096];
+};
+
+/** Destructor. */
+void Server_(struct Server **const s_ptr) {
+	struct Server *s;
+	if(!s_ptr || !(s = *s_ptr)) return;
+	if(s->client != -1) close(s->client);
+	if(s->fd != -1) close(s->fd);
+	if(s->socket && unlink(s->socket)) perror(s->socket);
+	free(s);
+	*s_ptr = 0;
+}
+
+/** @return Whether `str` is all digits. */
+static int is_port(const char *str) {
+	if(!*str) return 0;
+	for( ; *str; str++) if(*str < '0' || *str > '9') return 0;
+	return 1;
+}
+
+/** Listens on `address`, which is a port on the loopback, if it's a number,
+ or else a Unix domain socket that it makes; an old socket that's there is
+ replaced. @return The server or null.
+ @throws[malloc, socket, bind, listen, EDOM, EEXIST, ENAMETOOLONG] */
+struct Server *Server(const char *const address) {
+	struct Server *s;
+	assert(address);
+	if(!(s = malloc(sizeof *s + strlen(address) + 1))) return 0;
+	s->client = -1, s->is_head = 0;
+	s->socket = 0;
+	if(is_port(address)) {
+		struct sockaddr_in in;
+		const unsigned long port = strtoul(address, 0, 10);
+		const int yes = 1;
+		if(!port || port > 65535) { errno = EDOM; s->fd = -1; goto catch; }
+		memset(&in, 0, sizeof in);
+		in.sin_family = AF_INET;
+		in.sin_port = htons((unsigned short)port);
+		in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if((s->fd = socket(AF_INET, SOCK_STREAM, 0)) == -1
+			|| setsockopt(s->fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes)
+			|| bind(s->fd, (const struct sockaddr *)(const void *)&in,
+			sizeof in)) goto catch;
+	} else {
+		struct sockaddr_un un;
+		struct stat st;
+		if(strlen(address) >= sizeof un.sun_path)
+			{ errno = ENAMETOOLONG; s->fd = -1; goto catch; }
+		if(!lstat(address, &st)) {
+			s->fd = -1;
+			if(!S_ISSOCK(st.st_mode)) { errno = EEXIST; goto catch; }
+			if(unlink(address)) goto catch;
+		}
+		memset(&un, 0, sizeof un);
+		un.sun_family = AF_UNIX;
+		strcpy(un.sun_path, address);
+		if((s->fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1
+			|| bind(s->fd, (const struct sockaddr *)(const void *)&un,
+			sizeof un)) goto catch;
+		s->socket = (char *)(s + 1);
+		strcpy(s->socket, address);
+	}
+	if(listen(s->fd, backlog)) goto catch;
+	return s;
+catch:
+	{ const int e = errno; Server_(&s); errno = e; }
+	return 0;
+}
+
+/** Writes all `size` of `data` to the client of `s`. @return Success. */
+static int send_all(struct Server *const s, const char *data, size_t size) {
+	ssize_t w;
+	while(size) {
+		if((w = send(s->client, data, size, MSG_NOSIGNAL)) == -1)
+			{ if(errno == EINTR) continue; return 0; }
+		data += w, size -= (size_t)w;
+	}
+	return 1;
+}
+
+/** @return The reason for `status`. */
+static const char *reason(const int status) {
+	switch(status) {
+	case 200: return "OK";
+	case 400: return "Bad Request";
+	case 404: return "Not Found";
+	case 405: return "Method Not Allowed";
+	default: return "Internal Server Error";
+	}
+}
+
+/** Answers the request of `s` with `status` and `size` of `data`, which is a
+ page, or, if it's null, the reason; it's closed after.
+ @return Success; the client going away is not an error.
+ @throws[send, close] */
+int ServerReply(struct Server *const s, const int status,
+	const char *const data, const size_t size) {
+	char head[256];
+	const char *const body = data ? data : reason(status);
+	const size_t length = data ? size : strlen(body);
+	int success = 1;
+	assert(s);
+	if(s->client == -1) return 1;
+	sprintf(head, "HTTP/1.0 %d %s\r\nContent-Type: text/%s\r\n"
+		"Content-Length: %lu\r\nConnection: close\r\n\r\n", status,
+		reason(status), data ? "html" : "plain", (unsigned long)length);
+	if(!send_all(s, head, strlen(head))
+		|| !s->is_head && !send_all(s, body, length)) {
+		if(errno != EPIPE && errno != ECONNRESET) success = 0;
+	}
+	if(close(s->client)) success = 0;
+	s->client = -1;
+	return success;
+}
+
+/** @return The value of the hexadecimal digit `c`, or -1. */
+static int hex(const char c) {
+	if(c >= '0' && c <= '9') return c - '0';
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+/** Decodes the `%XX` in `path`, in place, and checks that it's a path that
+ stays under the root. @return Success. */
+static int decode(char *const path) {
+	char *a, *b;
+	int x, y;
+	if(*path != '/') return 0;
+	for(a = b = path; *a; a++, b++) {
+		if(*a != '%') { *b = *a; continue; }
+		if((x = hex(a[1])) == -1 || (y = hex(a[2])) == -1 || !(x || y))
+			return 0;
+		*b = (char)(x << 4 | y), a += 2;
+	}
+	*b = '\0';
+	/* no going up */
+	for(a = path; (a = strchr(a, '/')); a++)
+		if(a[1] == '.' && a[2] == '.' && (a[3] == '/' || !a[3])) return 0;
+	return 1;
+}
+
+/** Reads the head of the request of the client of `s`. @return Success.
+ @throws[poll, read, EIO, ETIMEDOUT] */
+static int head(struct Server *const s) {
+	size_t size = 0;
+	ssize_t rd;
+	struct pollfd p;
+	int ready;
+	while(size < sizeof s->request - 1) {
+		p.fd = s->client, p.events = POLLIN, p.revents = 0;
+		if((ready = poll(&p, 1, client_timeout)) <= 0)
+			{ if(!ready) errno = ETIMEDOUT; return 0; }
+		if((rd = read(s->client, s->request + size,
+			sizeof s->request - 1 - size)) <= 0)
+			{ if(!rd) errno = EIO; return 0; }
+		size += (size_t)rd;
+		s->request[size] = '\0';
+		/* only the first line matters, but the rest is read so it's not
+		 reset when it's closed */
+		if(strstr(s->request, "\r\n\r\n") || strstr(s->request, "\n\n"))
+			return 1;
+	}
+	return 1;
+}
+
+/** Waits for the next `GET` or `HEAD` to `s`, and puts it in `r`; the last
+ one that wasn't replied to is dropped. @return One if there's a request, or
+ -1 on error. @throws[poll, accept] Including `EINTR` for a signal. */
+int ServerNext(struct Server *const s, struct ServerRequest *const r) {
+	struct pollfd p;
+	char *target, *end;
+	int status;
+	assert(s && r);
+	for( ; ; ) {
+		if(s->client != -1) close(s->client), s->client = -1;
+		p.fd = s->fd, p.events = POLLIN, p.revents = 0;
+		if(poll(&p, 1, -1) == -1) return -1;
+		if((s->client = accept(s->fd, 0, 0)) == -1) {
+			if(errno == ECONNABORTED) continue;
+			return -1;
+		}
+		s->is_head = 0;
+		if(!head(s)) continue; /* it's their problem */
+		/* <method> <target> HTTP/1.x */
+		if(!memcmp(s->request, "GET ", 4)) target = s->request + 4;
+		else if(!memcmp(s->request, "HEAD ", 5))
+			target = s->request + 5, s->is_head = 1;
+		else { status = 405; goto reply; }
+		if(!(end = strpbrk(target, " \r\n"))) { status = 400; goto reply; }
+		*end = '\0';
+		if((end = strchr(target, '?'))) *end = '\0';
+		if(!decode(target)) { status = 400; goto reply; }
+		r->path = target, r->is_head = s->is_head;
+		return 1;
+reply:
+		ServerReply(s, status, 0, 0);
+	}
+}
@@ -0,0 +1,11 @@
+/** A request from <fn:ServerNext>; `path` is decoded, without the query, and
+ can be changed until the reply. */
+struct ServerRequest { char *path; int is_head; };
+
+struct Server;
+
+struct Server *Server(const char *const address);
+void Server_(struct Server **const s_ptr);
+int ServerNext(struct Server *const s, struct ServerRequest *const r);
+int ServerReply(struct Server *const s, const int status,
+	const char *const data, const size_t size);
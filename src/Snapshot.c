@@ -0,0 +1,242 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Snapshot
+ @author Neil
+
+ A `Snapshot` is the persisted state of the last run: for every directory, the
+ hash of its path, a digest of everything that went into its page, (the
+ names, sizes, and modification times of the entries, and the sidecars, see
+ <fn:FilesDepend>,) and how many pages of the index were written, so that
+ only those are ever taken away. The header has the hash of the templates; if
+ they change, the digests of the old snapshot are thrown away, but the pages
+ are still what was written.
+
+ The file is the header followed by the records sorted by path, in native
+ byte-order, so that the old one can be `mmap`ed and searched in place; the
+ new one is written beside it and renamed over it.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>    /* malloc realloc free qsort bsearch */
+#include <stdio.h>     /* fprintf perror renameat */
+#include <string.h>    /* memcmp strlen strcpy strcat */
+#include <errno.h>
+#include <unistd.h>    /* close write unlinkat */
+#include <fcntl.h>     /* openat */
+#include <sys/types.h>
+#include <sys/stat.h>  /* fstat */
+#include <sys/mman.h>  /* mmap munmap */
+#include <assert.h>
+#include "Snapshot.h"
+
+/* constants */
+static const char magic[8] = { 'm', 'k', 'i', 'd', 'x', 's', 'n', 'p' };
+static const unsigned long version = 2;
+static const char *dot_temp = ".tmp";
+
+struct Header {
+	char magic[8];
+	unsigned long version, templates, count;
+};
+struct Record { unsigned long path, inputs, pages, order; };
+
+/* public */
+struct Snapshot {
+	int dirfd;
+	char *fn;
+	unsigned long templates;
+	struct { void *map; size_t size; const struct Record *record;
+		size_t count; int same; } old;
+	struct { struct Record *record; size_t count, capacity; } new;
+};
+
+/** Orders `Record` by path. */
+static int compare(const void *a, const void *b) {
+	const unsigned long x = ((const struct Record *)a)->path,
+		y = ((const struct Record *)b)->path;
+	return x < y ? -1 : x > y;
+}
+
+/** Orders `Record` by path, and the last one put first. */
+static int compare_order(const void *a, const void *b) {
+	const int c = compare(a, b);
+	const unsigned long x = ((const struct Record *)a)->order,
+		y = ((const struct Record *)b)->order;
+	return c ? c : x > y ? -1 : x < y;
+}
+
+/** Maps the previous snapshot, if it exists; it's only `same` if it matches
+ `s->templates`. Not finding one is not an error. */
+static void map_old(struct Snapshot *const s) {
+	const struct Header *h;
+	struct stat st;
+	int fd;
+	assert(s && !s->old.map);
+	if((fd = openat(s->dirfd, s->fn, O_RDONLY)) == -1) {
+		if(errno != ENOENT) perror(s->fn);
+		errno = 0;
+		return;
+	}
+	if(fstat(fd, &st) || (size_t)st.st_size < sizeof *h) goto finally;
+	s->old.size = (size_t)st.st_size;
+	if((s->old.map = mmap(0, s->old.size, PROT_READ, MAP_PRIVATE, fd, 0))
+		== MAP_FAILED) { perror(s->fn); s->old.map = 0; goto finally; }
+	h = s->old.map;
+	if(memcmp(h->magic, magic, sizeof magic) || h->version != version
+		|| h->count > (s->old.size - sizeof *h) / sizeof(struct Record)) {
+		fprintf(stderr, "Snapshot: <%s> is not a snapshot; ignoring.\n", s->fn);
+	} else {
+		s->old.record = (const struct Record *)(h + 1);
+		s->old.count  = h->count;
+		s->old.same   = h->templates == s->templates;
+	}
+finally:
+	if(close(fd)) perror(s->fn);
+}
+
+/** Opens the snapshot `fn` in `dirfd`, if it exists, and starts a new one;
+ `dirfd` must stay open while it's used.
+ @param[templates] A hash of all the templates; the previous snapshot is only
+ used if it matches.
+ @return The snapshot or null. @throws[malloc] */
+struct Snapshot *Snapshot(const int dirfd, const char *const fn,
+	const unsigned long templates) {
+	struct Snapshot *s;
+	assert(fn);
+	if(!(s = malloc(sizeof *s + strlen(fn) + 1))) return 0;
+	s->dirfd = dirfd;
+	s->fn = (char *)(s + 1);
+	strcpy(s->fn, fn);
+	s->templates     = templates;
+	s->old.map       = 0;
+	s->old.size      = 0;
+	s->old.record    = 0;
+	s->old.count     = 0;
+	s->old.same      = 0;
+	s->new.record    = 0;
+	s->new.count     = 0;
+	s->new.capacity  = 0;
+	map_old(s);
+	return s;
+}
+
+/** Destructor; doesn't write; see <fn:SnapshotWrite>. */
+void Snapshot_(struct Snapshot **const s_ptr) {
+	struct Snapshot *s;
+	if(!s_ptr || !(s = *s_ptr)) return;
+	if(s->old.map && munmap(s->old.map, s->old.size)) perror(s->fn);
+	free(s->new.record);
+	free(s);
+	*s_ptr = 0;
+}
+
+/** @return The record of the directory `path` last run, or null. */
+static const struct Record *find(const struct Snapshot *const s,
+	const unsigned long path) {
+	struct Record key;
+	if(!s || !s->old.count) return 0;
+	key.path = path;
+	return bsearch(&key, s->old.record, s->old.count, sizeof key, &compare);
+}
+
+/** @return Whether the directory `path` had a digest of `inputs` last run,
+ with the same templates. */
+int SnapshotSame(const struct Snapshot *const s, const unsigned long path,
+	const unsigned long inputs) {
+	const struct Record *const found = find(s, path);
+	return found && s->old.same && found->inputs == inputs;
+}
+
+/** @return How many pages of the index of the directory `path` were written
+ last run, or zero if it's not known. */
+size_t SnapshotPages(const struct Snapshot *const s,
+	const unsigned long path) {
+	const struct Record *const found = find(s, path);
+	return found ? (size_t)found->pages : 0;
+}
+
+/** @return Whether any directory was on more than one page last run. */
+int SnapshotIsPaged(const struct Snapshot *const s) {
+	size_t i;
+	if(!s) return 0;
+	for(i = 0; i < s->old.count; i++) if(s->old.record[i].pages > 1) return 1;
+	return 0;
+}
+
+/** Records that directory `path` has the digest `inputs`, and it's index is
+ on `pages`, this run; the last one put is the one that stays.
+ @return Success. @throws[realloc] */
+int SnapshotPut(struct Snapshot *const s, const unsigned long path,
+	const unsigned long inputs, const size_t pages) {
+	struct Record *record;
+	if(!s) return 0;
+	if(s->new.count >= s->new.capacity) {
+		size_t c = s->new.capacity ? s->new.capacity << 1 : 256;
+		if(!(record = realloc(s->new.record, c * sizeof *record))) return 0;
+		s->new.record   = record;
+		s->new.capacity = c;
+	}
+	record = s->new.record + s->new.count++;
+	record->path   = path;
+	record->inputs = inputs;
+	record->pages  = (unsigned long)pages;
+	record->order  = (unsigned long)s->new.count;
+	return 1;
+}
+
+/** Writes everything that was put into a temporary file and renames it over
+ the snapshot, which is then what was last run; it can be written again with
+ more put. @return Success. @throws[open, write, rename] */
+int SnapshotWrite(struct Snapshot *const s) {
+	struct Header h;
+	char *temp;
+	const char *buf;
+	size_t left, i, n;
+	ssize_t w;
+	int fd = -1, success = 0, stage;
+	if(!s) return 0;
+	if(!(temp = malloc(strlen(s->fn) + strlen(dot_temp) + 1))) return 0;
+	strcpy(temp, s->fn);
+	strcat(temp, dot_temp);
+	/* the same directory more than once, (watching,) is the last one */
+	qsort(s->new.record, s->new.count, sizeof *s->new.record, &compare_order);
+	for(n = 0, i = 0; i < s->new.count; i++) {
+		if(n && s->new.record[n - 1].path == s->new.record[i].path) continue;
+		s->new.record[n] = s->new.record[i];
+		s->new.record[n].order = (unsigned long)n, n++;
+	}
+	s->new.count = n;
+	memcpy(h.magic, magic, sizeof magic);
+	h.version   = version;
+	h.templates = s->templates;
+	h.count     = s->new.count;
+	if((fd = openat(s->dirfd, temp, O_WRONLY | O_CREAT | O_TRUNC, 0666))
+		== -1) goto catch;
+	for(stage = 0; stage < 2; stage++) {
+		if(!stage) buf = (const char *)&h, left = sizeof h;
+		else buf = (const char *)s->new.record,
+			left = s->new.count * sizeof *s->new.record;
+		while(left) {
+			if((w = write(fd, buf, left)) == -1)
+				{ if(errno == EINTR) continue; goto catch; }
+			buf += w, left -= (size_t)w;
+		}
+	}
+	if(close(fd)) { fd = -1; goto catch; }
+	fd = -1;
+	if(renameat(s->dirfd, temp, s->dirfd, s->fn)) goto catch;
+	if(s->old.map && munmap(s->old.map, s->old.size)) perror(s->fn);
+	s->old.map = 0, s->old.size = 0, s->old.record = 0, s->old.count = 0;
+	map_old(s);
+	success = 1;
+	goto finally;
+catch:
+	perror(temp);
+	if(fd != -1) close(fd);
+	unlinkat(s->dirfd, temp, 0);
+finally:
+	free(temp);
+	return success;
+}
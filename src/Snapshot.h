@@ -0,0 +1,13 @@
+struct Snapshot;
+
+struct Snapshot *Snapshot(const int dirfd, const char *const fn,
+	const unsigned long templates);
+void Snapshot_(struct Snapshot **const s_ptr);
+int SnapshotSame(const struct Snapshot *const s, const unsigned long path,
+	const unsigned long inputs);
+size_t SnapshotPages(const struct Snapshot *const s,
+	const unsigned long path);
+int SnapshotIsPaged(const struct Snapshot *const s);
+int SnapshotPut(struct Snapshot *const s, const unsigned long path,
+	const unsigned long inputs, const size_t pages);
+int SnapshotWrite(struct Snapshot *const s);
@@ -0,0 +1,191 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Stats
+ @author Neil
+
+ `Stats` counts and times the phases of a run, (listing, status, filtering,
+ rendering, and writing,) and keeps the `slowest` directories. Every thread
+ has it's own, and they are put together with <fn:StatsMerge> at the end;
+ <fn:StatsReport> writes it as JSON.
+
+ All the functions take a null `Stats` and do nothing, so that the calls can
+ stay in when it's off; <fn:StatsStart> doesn't even look at the clock.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h> /* malloc free */
+#include <stdio.h>  /* fprintf */
+#include <string.h> /* strlen memcpy */
+#include <time.h>   /* clock_gettime */
+#include <assert.h>
+#include "Stats.h"
+
+/* The names of `StatsPhase` in the report. */
+static const char *const phase_names[]
+	= { "list", "stat", "filter", "render", "write" };
+
+struct Stats {
+	double start;
+	struct { unsigned long count; double seconds; } phase[StatsPhases];
+	unsigned long directories, bytes;
+	struct { char *path; double seconds; } *slow;
+	size_t slow_size, slowest;
+};
+
+/** @return Seconds on a clock that doesn't go back. */
+static double now(void) {
+	struct timespec ts;
+	if(clock_gettime(CLOCK_MONOTONIC, &ts)) return 0.0;
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/** @return An empty `Stats`, started now, that remembers the `slowest`
+ directories, or null. @throws[malloc] */
+struct Stats *Stats(const size_t slowest) {
+	struct Stats *s;
+	size_t i;
+	if(!(s = malloc(sizeof *s))) return 0;
+	s->slow = 0, s->slow_size = 0, s->slowest = slowest;
+	if(slowest && !(s->slow = malloc(sizeof *s->slow * slowest)))
+		{ free(s); return 0; }
+	s->start = now();
+	for(i = 0; i < StatsPhases; i++)
+		s->phase[i].count = 0, s->phase[i].seconds = 0.0;
+	s->directories = s->bytes = 0;
+	return s;
+}
+
+/** Destructor. */
+void Stats_(struct Stats **const s_ptr) {
+	struct Stats *s;
+	size_t i;
+	if(!s_ptr || !(s = *s_ptr)) return;
+	for(i = 0; i < s->slow_size; i++) free(s->slow[i].path);
+	free(s->slow);
+	free(s);
+	*s_ptr = 0;
+}
+
+/** @return The time to give to <fn:StatsStop>. */
+double StatsStart(const struct Stats *const s) { return s ? now() : 0.0; }
+
+/** Adds the time since `start` and `count` to `phase`. */
+void StatsStop(struct Stats *const s, const enum StatsPhase phase,
+	const double start, const unsigned long count) {
+	if(!s) return;
+	assert(phase < StatsPhases);
+	s->phase[phase].count += count;
+	s->phase[phase].seconds += now() - start;
+}
+
+/** Adds `bytes` to what was written. */
+void StatsBytes(struct Stats *const s, const unsigned long bytes) {
+	if(s) s->bytes += bytes;
+}
+
+/** Counts a directory that was started at `start`.
+ @return How long it took, for <fn:StatsIsSlow>. */
+double StatsDirectory(struct Stats *const s, const double start) {
+	if(!s) return 0.0;
+	s->directories++;
+	return now() - start;
+}
+
+/** @return The index of the fastest of the slowest. */
+static size_t fastest(const struct Stats *const s) {
+	size_t i, min = 0;
+	for(i = 1; i < s->slow_size; i++)
+		if(s->slow[i].seconds < s->slow[min].seconds) min = i;
+	return min;
+}
+
+/** @return Whether a directory that took `seconds` is one of the slowest, so
+ that it's worth making it's path. */
+int StatsIsSlow(const struct Stats *const s, const double seconds) {
+	if(!s || !s->slowest) return 0;
+	return s->slow_size < s->slowest
+		|| seconds > s->slow[fastest(s)].seconds;
+}
+
+/** Keeps `path` if it's one of the slowest at `seconds`.
+ @return Success. @throws[malloc] */
+int StatsSlow(struct Stats *const s, const char *const path,
+	const double seconds) {
+	const size_t len = strlen(path) + 1;
+	size_t i;
+	char *copy;
+	if(!StatsIsSlow(s, seconds)) return 1;
+	if(!(copy = malloc(len))) return 0;
+	memcpy(copy, path, len);
+	if(s->slow_size < s->slowest) i = s->slow_size++;
+	else free(s->slow[i = fastest(s)].path);
+	s->slow[i].path = copy, s->slow[i].seconds = seconds;
+	return 1;
+}
+
+/** Adds `from`, which is a different thread, to `s`.
+ @return Success. @throws[malloc] */
+int StatsMerge(struct Stats *const s, const struct Stats *const from) {
+	size_t i;
+	if(!s || !from) return 1;
+	for(i = 0; i < StatsPhases; i++) {
+		s->phase[i].count += from->phase[i].count;
+		s->phase[i].seconds += from->phase[i].seconds;
+	}
+	s->directories += from->directories;
+	s->bytes += from->bytes;
+	for(i = 0; i < from->slow_size; i++)
+		if(!StatsSlow(s, from->slow[i].path, from->slow[i].seconds)) return 0;
+	return 1;
+}
+
+/** Writes `str` as a JSON string to `fp`. */
+static void json_string(const char *str, FILE *const fp) {
+	fputc('\"', fp);
+	for( ; *str; str++) {
+		const unsigned char c = (unsigned char)*str;
+		if(c == '\"' || c == '\\') fputc('\\', fp), fputc(c, fp);
+		else if(c < 0x20) fprintf(fp, "\\u%04x", c);
+		else fputc(c, fp);
+	}
+	fputc('\"', fp);
+}
+
+/** @implements qsort */
+static int slow_cmp(const void *a, const void *b) {
+	const double x = *(const double *)a, y = *(const double *)b;
+	return (x < y) - (x > y);
+}
+
+/** Writes `s` to `fp` as JSON; the times of the phases are added over the
+ threads, so they can be more than the time of the run. The slowest are in
+ order. @return Success. @throws[malloc, fprintf] */
+int StatsReport(const struct Stats *const s, FILE *const fp) {
+	struct { double seconds; size_t i; } *order = 0;
+	size_t i;
+	assert(s && fp);
+	if(s->slow_size && !(order = malloc(sizeof *order * s->slow_size)))
+		return 0;
+	for(i = 0; i < s->slow_size; i++)
+		order[i].seconds = s->slow[i].seconds, order[i].i = i;
+	/* `seconds` is first, so it's a double */
+	if(order) qsort(order, s->slow_size, sizeof *order, &slow_cmp);
+	fprintf(fp, "{\n  \"seconds\": %.6f,\n  \"directories\": %lu,\n"
+		"  \"bytes\": %lu,\n  \"phases\": {\n",
+		now() - s->start, s->directories, s->bytes);
+	for(i = 0; i < StatsPhases; i++) fprintf(fp,
+		"    \"%s\": { \"count\": %lu, \"seconds\": %.6f }%s\n",
+		phase_names[i], s->phase[i].count, s->phase[i].seconds,
+		i + 1 < StatsPhases ? "," : "");
+	fprintf(fp, "  },\n  \"slowest\": [");
+	for(i = 0; i < s->slow_size; i++) {
+		fprintf(fp, "%s\n    { \"path\": ", i ? "," : "");
+		json_string(s->slow[order[i].i].path, fp);
+		fprintf(fp, ", \"seconds\": %.6f }", order[i].seconds);
+	}
+	fprintf(fp, "%s]\n}\n", s->slow_size ? "\n  " : "");
+	free(order);
+	return !ferror(fp);
+}
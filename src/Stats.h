@@ -0,0 +1,18 @@
+/** What the time is spent on. */
+enum StatsPhase { StatsList, StatsStat, StatsFilter, StatsRender, StatsWrite,
+	StatsPhases };
+
+struct Stats;
+
+struct Stats *Stats(const size_t slowest);
+void Stats_(struct Stats **const s_ptr);
+double StatsStart(const struct Stats *const s);
+void StatsStop(struct Stats *const s, const enum StatsPhase phase,
+	const double start, const unsigned long count);
+void StatsBytes(struct Stats *const s, const unsigned long bytes);
+double StatsDirectory(struct Stats *const s, const double start);
+int StatsIsSlow(const struct Stats *const s, const double seconds);
+int StatsSlow(struct Stats *const s, const char *const path,
+	const double seconds);
+int StatsMerge(struct Stats *const s, const struct Stats *const from);
+int StatsReport(const struct Stats *const s, FILE *const fp);
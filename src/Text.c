@@ -0,0 +1,303 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Text
+ @author Neil
+
+ `Text` is a growable output buffer that is reused from page to page, so that
+ rendering is just copying into memory. If it can't grow, it remembers, drops
+ everything after, and fails when it's written.
+
+ Pages are published by writing them to `<name>.tmp` in one `write` and
+ renaming that over `<name>`, so that no-one ever sees half of a page. Longer
+ output, like the sitemap, is flushed to the temporary file as it goes, and
+ renamed at the end. If `<name>` already has exactly those bytes, it is left
+ alone, so it keeps it's time and anything watching it doesn't see a change.
+ With `zlib`, a page can also be compressed for serving as `<name>.gz`.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>   /* realloc free */
+#include <stdio.h>    /* perror renameat */
+#include <string.h>   /* memcpy strlen */
+#include <errno.h>
+#include <unistd.h>   /* read write close unlinkat */
+#include <fcntl.h>    /* openat */
+#include <sys/stat.h> /* fstat */
+#include <zlib.h>     /* deflate */
+#include <assert.h>
+#include "Text.h"
+
+/* constants */
+const char *dot_temp = ".tmp"; /* used in multiple files */
+const char *dot_gz   = ".gz";
+static const size_t max_name = 256;
+
+/* public */
+struct Text {
+	char *data;
+	size_t size, capacity;
+	int error;
+};
+
+/** @return An empty text or null. @throws[malloc] */
+struct Text *Text(void) {
+	struct Text *t;
+	if(!(t = malloc(sizeof *t))) return 0;
+	t->data = 0, t->size = t->capacity = 0, t->error = 0;
+	return t;
+}
+
+/** Destructor. */
+void Text_(struct Text **const t_ptr) {
+	struct Text *t;
+	if(!t_ptr || !(t = *t_ptr)) return;
+	free(t->data);
+	free(t);
+	*t_ptr = 0;
+}
+
+/** Empties `t`, keeping the memory, and forgets any error. */
+void TextClear(struct Text *const t) {
+	if(!t) return;
+	t->size = 0, t->error = 0;
+}
+
+/** @return The contents of `t`, which are not null-terminated, and the size in
+ `size`. */
+const char *TextData(const struct Text *const t, size_t *const size) {
+	if(size) *size = t ? t->size : 0;
+	return t ? t->data : 0;
+}
+
+/** @return The number of bytes in `t`. */
+size_t TextSize(const struct Text *const t) { return t ? t->size : 0; }
+
+/** @return Whether `t` has failed to grow since the last <fn:TextClear>. */
+int TextIsError(const struct Text *const t) { return !t || t->error; }
+
+/** @return Whether `t` has room for `size` more. */
+static int reserve(struct Text *const t, const size_t size) {
+	size_t c;
+	char *data;
+	assert(t);
+	if(t->error) return 0;
+	if(t->size + size <= t->capacity) return 1;
+	for(c = t->capacity ? t->capacity : 4096; c < t->size + size; c <<= 1);
+	if(!(data = realloc(t->data, c))) { t->error = 1; return 0; }
+	t->data = data, t->capacity = c;
+	return 1;
+}
+
+/** Appends `size` bytes of `data` to `t`. */
+void TextCat(struct Text *const t, const char *const data, const size_t size) {
+	if(!t || !size || !reserve(t, size)) return;
+	memcpy(t->data + t->size, data, size);
+	t->size += size;
+}
+
+/** Appends the null-terminated `str` to `t`. */
+void TextString(struct Text *const t, const char *const str) {
+	if(str) TextCat(t, str, strlen(str));
+}
+
+/** Appends `c` to `t`. */
+void TextChar(struct Text *const t, const char c) {
+	if(!t || !reserve(t, 1)) return;
+	t->data[t->size++] = c;
+}
+
+/** Appends `no` in decimal, padded with zeros to at least `width`. */
+void TextNumber(struct Text *const t, long no, const unsigned width) {
+	char buf[32], *a = buf + sizeof buf;
+	unsigned long u = no < 0 ? 0ul - (unsigned long)no : (unsigned long)no;
+	do *--a = (char)('0' + u % 10); while(u /= 10);
+	while((size_t)(buf + sizeof buf - a) < width && a > buf + 1) *--a = '0';
+	if(no < 0) *--a = '-';
+	TextCat(t, a, (size_t)(buf + sizeof buf - a));
+}
+
+/** Puts the name of the temporary file for `name` in `buf`. @return Success. */
+static int temp(char *const buf, const char *const name) {
+	if(strlen(name) + strlen(dot_temp) >= max_name)
+		{ errno = ENAMETOOLONG; return 0; }
+	strcpy(buf, name);
+	strcat(buf, dot_temp);
+	return 1;
+}
+
+/** Starts writing `name` in `dirfd`. @return A file descriptor of the
+ temporary file or -1. @throws[openat] */
+int TextBegin(const int dirfd, const char *const name) {
+	char buf[256];
+	assert(name && sizeof buf == max_name);
+	if(!temp(buf, name)) return -1;
+	return openat(dirfd, buf, O_RDWR | O_CREAT | O_TRUNC, 0666);
+}
+
+/** Reads up to `size` into `buf` from `fd`, stopping short only at the end.
+ @return The number read or -1. @throws[read] */
+static ssize_t read_all(const int fd, char *const buf, const size_t size) {
+	size_t got = 0;
+	ssize_t rd;
+	while(got < size) {
+		if((rd = read(fd, buf + got, size - got)) == -1)
+			{ if(errno == EINTR) continue; return -1; }
+		if(!rd) break;
+		got += (size_t)rd;
+	}
+	return (ssize_t)got;
+}
+
+/** @return Whether `name` in `dirfd` is exactly `size` bytes of `data`, or,
+ if `data` is null, the same as the file `other`. Errors are just different. */
+static int same(const int dirfd, const char *const name,
+	const char *data, size_t size, const int other) {
+	char buf[8192], theirs[sizeof buf];
+	struct stat st;
+	ssize_t rd;
+	int fd, is = 0;
+	if((fd = openat(dirfd, name, O_RDONLY)) == -1) return 0;
+	if(fstat(fd, &st) || !S_ISREG(st.st_mode)) goto finally;
+	if(!data) {
+		struct stat ot;
+		if(fstat(other, &ot) || ot.st_size != st.st_size
+			|| lseek(other, 0, SEEK_SET)) goto finally;
+		size = (size_t)ot.st_size;
+	} else if((size_t)st.st_size != size || st.st_size < 0) goto finally;
+	while(size) {
+		const size_t chunk = size < sizeof buf ? size : sizeof buf;
+		if((rd = read_all(fd, buf, chunk)) != (ssize_t)chunk) goto finally;
+		if(data) {
+			if(memcmp(buf, data, chunk)) goto finally;
+			data += chunk;
+		} else {
+			if(read_all(other, theirs, chunk) != (ssize_t)chunk
+				|| memcmp(buf, theirs, chunk)) goto finally;
+		}
+		size -= chunk;
+	}
+	is = 1;
+finally:
+	close(fd);
+	return is;
+}
+
+/** Writes `size` bytes of `data` to `fd`. @return Success. @throws[write] */
+static int write_all(const char *data, size_t size, const int fd) {
+	ssize_t w;
+	for( ; size; data += w, size -= (size_t)w)
+		if((w = write(fd, data, size)) == -1)
+		{ if(errno == EINTR) { w = 0; continue; } return 0; }
+	return 1;
+}
+
+/** Writes all of `t` to `fd` and clears it. @return Success.
+ @throws[write, ENOMEM] */
+int TextFlush(struct Text *const t, const int fd) {
+	if(!t) return 0;
+	if(t->error) { errno = ENOMEM; return 0; }
+	if(!write_all(t->data, t->size, fd)) return 0;
+	t->size = 0;
+	return 1;
+}
+
+/** Finishes writing `name` in `dirfd` that was started with `fd`; if `commit`,
+ it replaces `name`, unless they are the same, otherwise it is discarded.
+ @param[written] If not null, set to whether `name` was replaced.
+ @return Success. @throws[close, renameat] */
+int TextEnd(const int dirfd, const char *const name, const int fd,
+	const int commit, int *const written) {
+	char buf[256];
+	int success = 1;
+	assert(name && sizeof buf == max_name);
+	if(written) *written = 0;
+	if(fd == -1) return 0;
+	if(!temp(buf, name)) return close(fd), 0;
+	if(commit && same(dirfd, name, 0, 0, fd)) {
+		/* it's the same as it was */
+		if(close(fd)) success = 0;
+		unlinkat(dirfd, buf, 0);
+		return success;
+	}
+	if(close(fd)) success = 0;
+	if(success && commit) {
+		if(renameat(dirfd, buf, dirfd, name)) success = 0;
+		else if(written) *written = 1;
+	} else {
+		unlinkat(dirfd, buf, 0);
+	}
+	return success && commit;
+}
+
+/** Replaces `name` in `dirfd` with the contents of `t` so that no-one ever
+ sees it half-written; if it's already that, it's not touched.
+ @param[written] If not null, set to whether `name` was replaced.
+ @return Success. @throws[openat, write, renameat] */
+int TextPublish(struct Text *const t, const int dirfd, const char *const name,
+	int *const written) {
+	int fd, success;
+	if(written) *written = 0;
+	if(!t) return 0;
+	if(t->error) { errno = ENOMEM; return 0; }
+	if(same(dirfd, name, t->data, t->size, -1)) return 1;
+	if((fd = TextBegin(dirfd, name)) == -1) return 0;
+	success = write_all(t->data, t->size, fd);
+	return TextEnd(dirfd, name, fd, success, written) && success;
+}
+
+/** Appends all of `name` in `dirfd` to `t`; it's read straight in, usually
+ with one `read`. @return Success; if it fails, `t` is as it was.
+ @throws[openat, fstat, read, ENOMEM] */
+int TextRead(struct Text *const t, const int dirfd, const char *const name) {
+	struct stat st;
+	ssize_t rd;
+	size_t was;
+	int fd, success = 0;
+	if(!t || (fd = openat(dirfd, name, O_RDONLY)) == -1) return 0;
+	was = t->size;
+	if(fstat(fd, &st)) goto finally;
+	/* one more, to see the end without growing */
+	if(!reserve(t, st.st_size > 0 ? (size_t)st.st_size + 1 : 4096))
+		{ errno = ENOMEM; goto finally; }
+	for( ; ; ) {
+		if(t->size == t->capacity && !reserve(t, t->capacity))
+			{ errno = ENOMEM; goto finally; }
+		if((rd = read(fd, t->data + t->size, t->capacity - t->size)) == -1)
+			{ if(errno == EINTR) continue; goto finally; }
+		if(!rd) break;
+		t->size += (size_t)rd;
+	}
+	success = 1;
+finally:
+	if(!success) t->size = was;
+	close(fd);
+	return success;
+}
+
+/** Replaces `to` with all of `from` compressed in the `gzip` format. The
+ header has no time or name, so the same `from` always gives the same bytes.
+ @return Success. @throws[ENOMEM, EDOM] */
+int TextGzip(const struct Text *const from, struct Text *const to) {
+	z_stream z;
+	int ret;
+	if(!from || !to) return 0;
+	if(from->error) { errno = ENOMEM; return 0; }
+	TextClear(to);
+	z.zalloc = Z_NULL, z.zfree = Z_NULL, z.opaque = Z_NULL;
+	/* 15 bits of window, +16 for a gzip wrapper */
+	if(deflateInit2(&z, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+		Z_DEFAULT_STRATEGY) != Z_OK) { errno = ENOMEM; return 0; }
+	if(!reserve(to, deflateBound(&z, (uLong)from->size)))
+		{ deflateEnd(&z); errno = ENOMEM; return 0; }
+	z.next_in   = (Bytef *)(size_t)from->data;
+	z.avail_in  = (uInt)from->size;
+	z.next_out  = (Bytef *)to->data;
+	z.avail_out = (uInt)to->capacity;
+	ret = deflate(&z, Z_FINISH);
+	to->size = to->capacity - z.avail_out;
+	deflateEnd(&z);
+	if(ret != Z_STREAM_END) { to->error = 1; errno = EDOM; return 0; }
+	return 1;
+}
@@ -0,0 +1,22 @@
+extern const char *dot_temp, *dot_gz;
+
+struct Text;
+
+struct Text *Text(void);
+void Text_(struct Text **const t_ptr);
+void TextClear(struct Text *const t);
+const char *TextData(const struct Text *const t, size_t *const size);
+size_t TextSize(const struct Text *const t);
+int TextIsError(const struct Text *const t);
+void TextCat(struct Text *const t, const char *const data, const size_t size);
+void TextString(struct Text *const t, const char *const str);
+void TextChar(struct Text *const t, const char c);
+void TextNumber(struct Text *const t, long no, const unsigned width);
+int TextBegin(const int dirfd, const char *const name);
+int TextFlush(struct Text *const t, const int fd);
+int TextEnd(const int dirfd, const char *const name, const int fd,
+	const int commit, int *const written);
+int TextPublish(struct Text *const t, const int dirfd, const char *const name,
+	int *const written);
+int TextRead(struct Text *const t, const int dirfd, const char *const name);
+int TextGzip(const struct Text *const from, struct Text *const to);
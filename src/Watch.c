@@ -0,0 +1,124 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Watch
+ @author Neil
+
+ `Watch` is a thin layer over inotify: one watch per directory, and the events
+ come out one at a time from <fn:WatchNext>, which waits up to a timeout for
+ them. It only reports changes to the entries of a directory, (created,
+ deleted, moved, or written and closed,) which is all that goes into an index.
+
+ @std Linux; elsewhere, <fn:Watch> always fails */
+
+#include <stdlib.h> /* malloc free */
+#include <errno.h>
+#include <assert.h>
+#include "Watch.h"
+
+#ifdef __linux__ /* <-- linux */
+
+#include <unistd.h>      /* read close */
+#include <poll.h>
+#include <sys/inotify.h>
+
+/* What changes a listing or a sidecar. */
+static const unsigned watch_mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM
+	| IN_MOVED_TO | IN_CLOSE_WRITE | IN_ONLYDIR;
+
+struct Watch {
+	int fd;
+	size_t size, pos;
+	/* aligned for `struct inotify_event` */
+	union { int align; char buf[65536]; } events;
+};
+
+/** Destructor. */
+void Watch_(struct Watch **const w_ptr) {
+	struct Watch *w;
+	if(!w_ptr || !(w = *w_ptr)) return;
+	if(w->fd != -1) close(w->fd);
+	free(w);
+	*w_ptr = 0;
+}
+
+/** @return A new `Watch` with nothing in it, or null.
+ @throws[malloc, inotify_init] */
+struct Watch *Watch(void) {
+	struct Watch *w;
+	if(!(w = malloc(sizeof *w))) return 0;
+	w->size = w->pos = 0;
+	if((w->fd = inotify_init()) == -1) Watch_(&w);
+	return w;
+}
+
+/** Watches the directory `path`.
+ @return The watch descriptor or -1. @throws[inotify_add_watch] */
+int WatchAdd(struct Watch *const w, const char *const path) {
+	assert(w && path);
+	return inotify_add_watch(w->fd, path, watch_mask);
+}
+
+/** Stops watching `wd`; it not being there, because the directory is gone, is
+ not an error. */
+void WatchRemove(struct Watch *const w, const int wd) {
+	assert(w);
+	if(wd != -1) inotify_rm_watch(w->fd, wd);
+}
+
+/** Waits up to `timeout` milliseconds, (negative is forever,) for the next
+ event of `w` and puts it in `e`; the name is good until the next call.
+ @return One if there's an event, zero if it timed-out, and -1 on error.
+ @throws[poll, read] Including `EINTR` for a signal. */
+int WatchNext(struct Watch *const w, const int timeout,
+	struct WatchEvent *const e) {
+	const struct inotify_event *ie;
+	assert(w && e);
+	if(w->pos >= w->size) {
+		struct pollfd p;
+		ssize_t rd;
+		int ready;
+		p.fd = w->fd, p.events = POLLIN, p.revents = 0;
+		if((ready = poll(&p, 1, timeout)) <= 0) return ready;
+		if((rd = read(w->fd, w->events.buf, sizeof w->events.buf)) <= 0)
+			{ if(!rd) errno = EIO; return -1; }
+		w->size = (size_t)rd, w->pos = 0;
+	}
+	ie = (const struct inotify_event *)(const void *)(w->events.buf + w->pos);
+	w->pos += sizeof *ie + ie->len;
+	e->wd = ie->wd;
+	e->isDir = !!(ie->mask & IN_ISDIR);
+	e->overflow = !!(ie->mask & IN_Q_OVERFLOW);
+	e->name = ie->len ? ie->name : "";
+	return 1;
+}
+
+#else /* linux --><-- !linux */
+
+struct Watch { int unused; };
+
+/** Not available. @return Null. @throws[ENOSYS] */
+struct Watch *Watch(void) { errno = ENOSYS; return 0; }
+
+/** Destructor. */
+void Watch_(struct Watch **const w_ptr) { if(w_ptr) *w_ptr = 0; }
+
+/** Not available. @return -1. @throws[ENOSYS] */
+int WatchAdd(struct Watch *const w, const char *const path) {
+	(void)w, (void)path;
+	errno = ENOSYS;
+	return -1;
+}
+
+/** Not available. */
+void WatchRemove(struct Watch *const w, const int wd) { (void)w, (void)wd; }
+
+/** Not available. @return -1. @throws[ENOSYS] */
+int WatchNext(struct Watch *const w, const int timeout,
+	struct WatchEvent *const e) {
+	(void)w, (void)timeout, (void)e;
+	errno = ENOSYS;
+	return -1;
+}
+
+#endif /* !linux --> */
@@ -0,0 +1,17 @@
+struct Watch;
+
+/** What <fn:WatchNext> saw. `wd` is what <fn:WatchAdd> returned for the
+ directory, and `name` is the entry in it that changed, or empty if it was
+ the directory itself; `overflow` means that events were lost, and anything
+ could have changed. */
+struct WatchEvent {
+	int wd, isDir, overflow;
+	const char *name;
+};
+
+struct Watch *Watch(void);
+void Watch_(struct Watch **const w_ptr);
+int WatchAdd(struct Watch *const w, const char *const path);
+void WatchRemove(struct Watch *const w, const int wd);
+int WatchNext(struct Watch *const w, const int timeout,
+	struct WatchEvent *const e);
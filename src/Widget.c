@@ -13,7 +13,7 @@
 
  See Parser for more information.
 
- @std POSIX.1 */
+ @std POSIX.1-2008 */
 
 /* 2017-03 fixed pedantic warnings; command-line improvements
  2008-03-25 */
@@ -21,34 +21,34 @@
 /* 2026-06-20 Icon `png` first, falls back to `jpeg`. I know that's a
  lot more space, but transparency is kind of important. */
 
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h> /* size_t getenv strtol */
 #include <string.h> /* strncat strncpy */
 #include <stdio.h>  /* fprintf FILE */
-#include <time.h>   /* time gmtime - for @date */
+#include <time.h>   /* time gmtime_r - for @now @lastmod */
 #include <errno.h>
 #include <assert.h>
 #include "Files.h"
+#include "Images.h"
 #include "Parser.h"
+#include "Text.h"
 #include "Widget.h"
 
 /* constants */
-static const char *html_desc    = "index.d";
 static const char *html_content = "content.d";
 static const char *separator    = "/";
 static const char *picture_png  = ".png";
 static const char *picture_jpeg = ".jpeg"; /* yeah, I hard coded this */
-static const size_t max_read    = 512;
-static const char *dot_link     = ".link";
-const char *dot_desc            = ".d"; /* used in multiple files */
+const char *html_desc           = "index.d"; /* used in multiple files */
+const char *dot_desc            = ".d";
 const char *dot_news            = ".news";
+const char *dot_link            = ".link";
+const char *icon_dir            = "dir.png"; /* at the root */
+const char *icon_file           = "file.png";
 extern const char *dir_current;
 extern const char *dir_parent;
-
-/* global, ick: news */
-static int year          = 1969;
-static int month         = 7;
-static int day           = 20;
-static char title[64]    = "(no title)";
-static char filenews[64] = "(no file name)";
+/* in MakeIndex.c */
+extern const char *html_index;
 
 /** @return `no` clipped between [`low`, `high`]. */
 static int clip(int no, const int low, const int high) {
@@ -58,35 +58,96 @@ static int clip(int no, const int low, const int high) {
 	return no;
 }
 
-/** Reads the news from `fn` into static variables for display in widgets. This
- will override the last one. @return Success. */
-int WidgetSetNews(const char *fn) {
+/** Puts the time of the build for `@(now)` in `now`, so that it's the same on
+ every page; this is the environment variable `SOURCE_DATE_EPOCH`, if it's
+ set, for reproducible builds, otherwise the current time. Call before
+ rendering, and give it to <fn:WidgetClear>.
+ @return Success. @throws[time, EDOM] */
+int WidgetSetNow(char (*const now)[24]) {
+	const char *const epoch = getenv("SOURCE_DATE_EPOCH");
+	time_t    currentTime;
+	struct tm formatedTime;
+	if(epoch) {
+		char *end;
+		long seconds;
+		errno = 0;
+		seconds = strtol(epoch, &end, 10);
+		if(end == epoch || *end || seconds < 0 || errno)
+			{ if(!errno) errno = EDOM; return 0; }
+		currentTime = (time_t)seconds;
+	} else if((currentTime = time(0)) == (time_t)(-1)) return 0;
+	if(!gmtime_r(&currentTime, &formatedTime)) return 0;
+	/* ISO 8601 - YYYY-MM-DDThh:mm:ssTZD */
+	if(!strftime(*now, sizeof *now, "%Y-%m-%dT%H:%M:%SZ", &formatedTime))
+		{ errno = EDOM; return 0; }
+	return 1;
+}
+
+/** Resets `w` to the start of rendering a build at `now`, from
+ <fn:WidgetSetNow>, which must stay, with the sizes of the icons kept in
+ `images`, which can be null. */
+void WidgetClear(struct Widget *const w, const char *const now,
+	struct Images *const images) {
+	assert(w && now);
+	w->news.year  = 1969;
+	w->news.month = 7;
+	w->news.day   = 20;
+	strcpy(w->news.title, "(no title)");
+	strcpy(w->news.name, "(no file name)");
+	w->news.dir  = 0;
+	w->news.body = 0;
+	w->news.size = 0;
+	w->pwd  = 0;
+	w->root = 0;
+	w->at   = 0;
+	w->now  = now;
+	w->images = images;
+	w->page = w->pages = 1;
+	w->link = 0;
+}
+
+/** Puts the file name of `page` of the index, counting from one, in `name`;
+ the first is `html_index`, and the rest are numbered, `index-2.html`. */
+void WidgetPageName(char (*const name)[64], const size_t page) {
+	const char *const dot = strrchr(html_index, '.');
+	const size_t stem = dot ? (size_t)(dot - html_index) : strlen(html_index);
+	assert(name && strlen(html_index) < sizeof *name - 24);
+	if(page <= 1) { strcpy(*name, html_index); return; }
+	sprintf(*name, "%.*s-%lu%s", (int)stem, html_index, (unsigned long)page,
+		dot ? dot : "");
+}
+
+/** Reads the news from `fn` in the directory of `f` into `w` for display in
+ widgets. This will override the last one. @return Success. */
+int WidgetSetNews(struct Widget *const w, struct Files *const f,
+	const char *fn) {
 	char *dot;
 	int  read;
 	size_t tLen;
 	FILE *fp = 0;
 	int success = 0;
-	if(!fn || !(dot = strstr(fn, dot_news)) || strlen(fn) > sizeof filenews - 1)
-		{ fprintf(stderr,
+	assert(w);
+	if(!fn || !(dot = strstr(fn, dot_news)) || strlen(fn) > sizeof w->news.name
+		- 1) { fprintf(stderr,
 		"Widget::WriteNews: news file invalid or too long (%lu,) <%s>.\n",
-		(unsigned long)sizeof filenews, fn); errno = EDOM; goto catch; }
+		(unsigned long)sizeof w->news.name, fn); errno = EDOM; goto catch; }
 	/* save the fn, safe because we checked it, and strip off .news */
-	strcpy(filenews, fn);
-	filenews[dot - fn] = '\0';
+	strcpy(w->news.name, fn);
+	w->news.name[dot - fn] = '\0';
 	/* open .news */
-	if(!(fp = fopen(fn, "r"))) goto catch;
-	read = fscanf(fp, "%d-%d-%d\n", &year, &month, &day);
+	if(!(fp = FilesOpen(f, fn, "r"))) goto catch;
+	read = fscanf(fp, "%d-%d-%d\n",
+		&w->news.year, &w->news.month, &w->news.day);
 	if(read < 3) { fprintf(stderr,
 		"Widget::WriteNews: error parsing ISO 8601, <YYYY-MM-DD>, <%s>.\n",
 		fn); errno = EDOM; goto catch; }
-	month = clip(month, 1, 12);
-	day   = clip(day,   1, 31);
+	w->news.month = clip(w->news.month, 1, 12);
+	w->news.day   = clip(w->news.day,   1, 31);
 	/* fgets reads a newline at the end (annoying) so we strip that off */
-	if(!fgets(title, (int)sizeof(title), fp)) { *title = '\0'; goto catch; }
-	else if((tLen = strlen(title)) > 0 && title[tLen - 1] == '\n')
-		title[tLen - 1] = '\0';
-	fprintf(stderr, "News <%s>, '%s' %d-%d-%d.\n",
-		filenews, title, year, month, day);
+	if(!fgets(w->news.title, (int)sizeof w->news.title, fp))
+		{ *w->news.title = '\0'; goto catch; }
+	else if((tLen = strlen(w->news.title)) > 0
+		&& w->news.title[tLen - 1] == '\n') w->news.title[tLen - 1] = '\0';
 	success = 1;
 	goto finally;
 catch:
@@ -97,110 +158,132 @@ finally:
 
 /* the widget handlers */
 
-/** Displays the content, (either `index.d` or `content.d`.) Ignores `f` and
- writes to `fp`. @implements ParserWidget @return Success. */
-int WidgetContent(struct Files *const f, FILE *const fp) {
-	char buf[81], *bufpos;
-	size_t i;
-	FILE *in;
-	(void)f;
-	assert(fp);
+/** Displays the content, (either `index.d` or `content.d`,) of the directory
+ of `f` and writes to `out`. @implements ParserWidget @return Success. */
+int WidgetContent(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	const char *data;
+	size_t size;
+	(void)w;
+	assert(out);
 	/* it's a nightmare to test if this is text (which most is,) in which case
 	 we should insert <p>...</p> after every paragraph, <>& -> &lt;&gt;&amp;,
 	 but we have to not translate already encoded html; the only solution that
 	 I could see is have a new language (like-LaTeX) that gracefully handles
 	 plain-text */
-	if((in = fopen(html_content, "r")) || (in = fopen(html_desc, "r"))) {
-		for(i = 0; (i < max_read)
-			&& (bufpos = fgets(buf, (int)sizeof buf, in)); i++) {
-			fprintf(fp, "%s", bufpos);
-		}
-		if(fclose(in) == EOF) perror("index");
-	}
+	if((data = FilesRead(f, html_content, &size))
+		|| (data = FilesRead(f, html_desc, &size))) TextCat(out, data, size);
 	return 0;
 }
-/** Ignores `f` and writes to `fp`. @implements ParserWidget */
-int WidgetDate(struct Files *const f, FILE *const fp) {
+/** Ignores `f` and writes to `out` the date of the news in `w`.
+ @implements ParserWidget */
+int WidgetDate(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
 	(void)f;
 	/* ISO 8601 - YYYY-MM-DD */
-	fprintf(fp, "%4.4d-%2.2d-%2.2d", year, month, day);
+	TextNumber(out, w->news.year, 4);
+	TextChar(out, '-');
+	TextNumber(out, w->news.month, 2);
+	TextChar(out, '-');
+	TextNumber(out, w->news.day, 2);
+	return 0;
+}
+/** Writes to `out` how many files are under `f`, if it's a directory and that's
+ known. @implements ParserWidget */
+int WidgetDircount(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	const struct FilesTotal *total;
+	(void)w;
+	if(!FilesIsDir(f) || !(total = FilesGetTotal(f))) return 0;
+	TextNumber(out, (long)total->files, 0);
 	return 0;
 }
-/** Writes to `fp` whether `f` is "Dir" or "File". @implements ParserWidget */
-int WidgetFilealt(struct Files *const f, FILE *const fp) {
-	fprintf(fp, "%s", FilesIsDir(f) ? "Dir" : "File");
+/** Writes to `out` whether `f` is "Dir" or "File". @implements ParserWidget */
+int WidgetFilealt(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	(void)w;
+	TextString(out, FilesIsDir(f) ? "Dir" : "File");
 	return 0;
 }
-/** Writes to `fp` the description of `f`, that is the `.d` file, if it can
+/** Writes to `out` the description of `f`, that is the `.d` file, if it can
  find it. @implements ParserWidget */
-int WidgetFiledesc(struct Files *const f, FILE *const fp) {
+int WidgetFiledesc(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
 	char buf[256];
-	const char *name;
-	FILE *in;
+	const char *name, *data;
+	size_t size;
+	(void)w;
 	if(!(name = FilesName(f))) return 0;
 	if(FilesIsDir(f)) {
-		/* <file>/index.d */
+		/* <file>/index.d, which is not in this listing */
 		strncpy(buf, name, sizeof(buf) - 9);
 		strncat(buf, separator, 1lu);
 		strncat(buf, html_desc, 7lu);
+		TextRead(out, FilesFd(f), buf); /* it not being there is fine */
 	} else {
 		/* <file>.d */
 		strncpy(buf, name, sizeof(buf) - 6);
 		strncat(buf, dot_desc, 5lu);
-	}
-	if((in = fopen(buf, "r"))) {
-		char *bufpos;
-		size_t i;
-		for(i = 0; (i < max_read)
-			&& (bufpos = fgets(buf, (int)sizeof(buf), in)); i++)
-			fprintf(fp, "%s", bufpos);
-		if(fclose(in)) perror(buf);
+		if((data = FilesRead(f, buf, &size))) TextCat(out, data, size);
 	}
 	return 0;
 }
-/** Writes to `fp` the first line in `f`. @implements ParserWidget */
-int WidgetFilehref(struct Files *const f, FILE *const fp) {
-	const char *str, *name;
-	int ch;
-	FILE *fhref;
+/** Writes to `out` the first line in `f`, if it's a `.link`, or else the
+ name. @implements ParserWidget */
+int WidgetFilehref(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	const char *str, *name, *link;
+	size_t size, i;
+	(void)w;
 	if(!(name = FilesName(f))) return 0;
 	if((str = strstr(name, dot_link)) && *(str += strlen(dot_link)) == '\0'
-		&& (fhref = fopen(name, "r"))) {
-		/* fixme: not too good, with the reading one char at a time */
-		for( ; ; ) {
-			ch = fgetc(fhref);
-			if(ch == '\n' || ch == '\r' || ch == EOF) break;
-			fprintf(fp, "%c", ch);
-		}
-		if(fclose(fhref)) perror(name);
+		&& (link = FilesRead(f, name, &size))) {
+		for(i = 0; i < size && link[i] != '\n' && link[i] != '\r'; i++);
+		TextCat(out, link, i);
 	} else {
-		fprintf(fp, "%s", name);
+		TextString(out, name);
 	}
 	return 0;
 }
-/** Writes to `fp` an icon of `f`, `.d.jpeg` if available.
- @implements ParserWidget
- @fixme Have a way to get dimensions: this is an _error_ in my page. */
-int WidgetFileicon(struct Files *const f, FILE *const fp) {
+/** Puts the icon of the file `name` in `f` in `buf`, `.d.png`, or `.d.jpeg`,
+ if it has one. @return Whether it did; otherwise, it's `icon_dir` or
+ `icon_file` at the root. */
+static int icon(const struct Files *const f, const char *const name,
+	char (*const buf)[256]) {
+	/* insert <file>.d.png or jpeg if available */
+	strncpy(*buf, name, sizeof(*buf) - 12);
+	strncat(*buf, dot_desc, 5lu);
+	strncat(*buf, picture_png, 6lu);
+	if(FilesHas(f, *buf)) return 1;
+	strncpy(*buf, name, sizeof(*buf) - 12);
+	strncat(*buf, dot_desc, 5lu);
+	strncat(*buf, picture_jpeg, 6lu);
+	if(FilesHas(f, *buf)) return 1;
+	return 0;
+}
+/** Gets the `width` and `height` of the icon of `f` with the `images` of `w`.
+ @return Whether it could tell. */
+static int dimensions(struct Files *const f, struct Widget *const w,
+	unsigned *const width, unsigned *const height) {
 	char buf[256];
 	const char *name;
-	FILE *in;
 	if(!(name = FilesName(f))) return 0;
-	/* insert <file>.d.png or jpeg if available */
-	strncpy(buf, name, sizeof(buf) - 12);
-	strncat(buf, dot_desc, 5lu);
-	strncat(buf, picture_png, 6lu);
-	if((in = fopen(buf, "r"))) {
-		fprintf(fp, "%s", buf);
-		if(fclose(in) == EOF) perror(buf);
-		goto finally;
-	}
-	strncpy(buf, name, sizeof(buf) - 12);
-	strncat(buf, dot_desc, 5lu);
-	strncat(buf, picture_jpeg, 6lu);
-	if((in = fopen(buf, "r"))) {
-		fprintf(fp, "%s", buf);
-		if(fclose(in) == EOF) perror(buf);
+	if(icon(f, name, &buf))
+		return ImagesSize(w->images, FilesFd(f), buf, width, height);
+	return ImagesSize(w->images, FilesRootFd(f),
+		FilesIsDir(f) ? icon_dir : icon_file, width, height);
+}
+/** Writes to `out` an icon of `f`, `.d.png` or `.d.jpeg` if available; see
+ <fn:WidgetIconwidth> and <fn:WidgetIconheight> for it's dimensions.
+ @implements ParserWidget */
+int WidgetFileicon(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	char buf[256];
+	const char *name;
+	(void)w;
+	if(!(name = FilesName(f))) return 0;
+	if(icon(f, name, &buf)) {
+		TextString(out, buf);
 		goto finally;
 	}
 	/* added thing to get to root instead of / because sometimes 'root'
@@ -208,87 +291,187 @@ int WidgetFileicon(struct Files *const f, FILE *const fp) {
 	 as having a @root{/} */
 	FilesSetPath((struct Files *)f);
 	while(FilesEnumPath((struct Files *)f)) {
-		fprintf(fp, "%s%s", dir_parent, separator);
+		TextString(out, dir_parent);
+		TextString(out, separator);
 	}
-	fprintf(fp, "%s%s", FilesIsDir(f) ? "dir" : "file", picture_png);
+	TextString(out, FilesIsDir(f) ? icon_dir : icon_file);
 finally:
 	return 0;
 }
-/** Writes to `fp` the name of `f`. @implements ParserWidget */
-int WidgetFilename(struct Files *const f, FILE *const fp) {
-	fprintf(fp, "%s", FilesName(f));
+/** Writes to `out` the name of `f`. @implements ParserWidget */
+int WidgetFilename(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	(void)w;
+	TextString(out, FilesName(f));
 	return 0;
 }
-/** Ignores `fp` and advances the global file from `f`.
+/** Ignores `out` and advances the global file from `f`.
  @implements ParserWidget */
-int WidgetFiles(struct Files *const f, FILE *const fp) {
-	(void)fp;
+int WidgetFiles(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	(void)out, (void)w;
 	return FilesAdvance((struct Files *)f) ? -1 : 0;
 }
-/** Writes to `fp` the size of `f` in KB. @implements ParserWidget */
-int WidgetFilesize(struct Files *const f, FILE *const fp) {
-	if(!FilesIsDir(f)) fprintf(fp, " (%d KB)", FilesSize(f));
+/** Writes to `out` the size of `f` in KB; of a directory, it's everything
+ under it, if that's known. @implements ParserWidget */
+int WidgetFilesize(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	(void)w;
+	if(!FilesGetTotal(f)) return 0;
+	TextString(out, " (");
+	TextNumber(out, FilesSize(f), 0);
+	TextString(out, " KB)");
+	return 0;
+}
+/** Writes to `out` the height of the icon of `f` in pixels, if it's a PNG or
+ a JPEG. @implements ParserWidget */
+int WidgetIconheight(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	unsigned width, height;
+	if(dimensions(f, w, &width, &height)) TextNumber(out, (long)height, 0);
 	return 0;
 }
-/** Ignores `f`, writes to `fp` the news contained in a global.
+/** Writes to `out` the width of the icon of `f` in pixels, if it's a PNG or
+ a JPEG. @implements ParserWidget */
+int WidgetIconwidth(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	unsigned width, height;
+	if(dimensions(f, w, &width, &height)) TextNumber(out, (long)width, 0);
+	return 0;
+}
+/** Writes to `out` the date `f` was modified, or the newest under it, if it's
+ a directory and that's known. @implements ParserWidget */
+int WidgetLastmod(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	const struct FilesTotal *total;
+	time_t t;
+	struct tm tm;
+	(void)w;
+	if(!(total = FilesGetTotal(f)) || !total->newest) return 0;
+	t = (time_t)total->newest;
+	if(!gmtime_r(&t, &tm)) return 0;
+	/* ISO 8601 - YYYY-MM-DD */
+	TextNumber(out, tm.tm_year + 1900, 4);
+	TextChar(out, '-');
+	TextNumber(out, tm.tm_mon + 1, 2);
+	TextChar(out, '-');
+	TextNumber(out, tm.tm_mday, 2);
+	return 0;
+}
+/** Writes to `out` the news contained in `w`, which is it's `body`, if it
+ came from a feed, or else in the directory of `f`. @implements ParserWidget */
+int WidgetNews(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	if(w->news.body) { TextCat(out, w->news.body, w->news.size); return 0; }
+	if(!w->news.name[0]) return 0;
+	/* it's read straight into `out`, but only if it's in the listing */
+	if(!FilesHas(f, w->news.name)) errno = ENOENT, perror(w->news.name);
+	else if(!TextRead(out, FilesFd(f), w->news.name)) perror(w->news.name);
+	return 0;
+}
+/** Ignores `f`. Writes to `out` the name of the current news in `w`.
  @implements ParserWidget */
-int WidgetNews(struct Files *const f, FILE *const fp) {
-	char buf[256], *bufpos;
-	size_t i;
-	FILE *in;
+int WidgetNewsname(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
 	(void)f;
-	if(!filenews[0]) return 0;
-	if(!(in = fopen(filenews, "r"))) { perror(filenews); return 0; }
-	for(i = 0; (i < max_read) && (bufpos = fgets(buf, (int)sizeof(buf), in));
-		i++) fprintf(fp, "%s", bufpos);
-	if(fclose(in) == EOF) perror(filenews);
+	TextString(out, w->news.name);
 	return 0;
 }
-/** Ignores `f`. Writes to `fp` the global name of the current news.
+/** Goes into it's argument once if there's a page of the index after this
+ one in `w`. @implements ParserWidget */
+int WidgetNext(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	(void)f, (void)out;
+	if(w->link) return w->link = 0;
+	return w->page < w->pages ? (w->link = 1, -1) : 0;
+}
+/** Writes to `out` the file name of the next page of the index in `w`, if
+ there is one. @implements ParserWidget */
+int WidgetNexthref(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	char name[64];
+	(void)f;
+	if(w->page >= w->pages) return 0;
+	WidgetPageName(&name, w->page + 1);
+	TextString(out, name);
+	return 0;
+}
+/** Ignores `f`. Writes to `out` the date of the build in `w`, from
+ <fn:WidgetSetNow>. @implements ParserWidget */
+int WidgetNow(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	(void)f;
+	TextString(out, w->now);
+	return 0;
+}
+/** Writes to `out` the number of the page of the index in `w`, from one.
  @implements ParserWidget */
-int WidgetNewsname(struct Files *const f, FILE *const fp) {
+int WidgetPage(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
 	(void)f;
-	fprintf(fp, "%s", filenews);
+	TextNumber(out, (long)w->page, 0);
 	return 0;
 }
-/** Ignores `f`. Writes to `fp` the date. @implements ParserWidget */
-int WidgetNow(struct Files *const f, FILE *const fp) {
-	char      t[22];
-	time_t    currentTime;
-	struct tm *formatedTime;
+/** Writes to `out` the number of pages of the index in `w`.
+ @implements ParserWidget */
+int WidgetPages(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
 	(void)f;
-	if((currentTime = time(0)) == (time_t)(-1)) { perror("@date"); return 0; }
-	formatedTime = gmtime(&currentTime);
-	/* ISO 8601 - YYYY-MM-DDThh:mm:ssTZD */
-	strftime(t, 21lu, "%Y-%m-%dT%H:%M:%SZ", formatedTime);
-	fprintf(fp, "%s", t);
+	TextNumber(out, (long)w->pages, 0);
+	return 0;
+}
+/** Goes into it's argument once if there's a page of the index before this
+ one in `w`. @implements ParserWidget */
+int WidgetPrev(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	(void)f, (void)out;
+	if(w->link) return w->link = 0;
+	return w->page > 1 ? (w->link = 1, -1) : 0;
+}
+/** Writes to `out` the file name of the previous page of the index in `w`, if
+ there is one. @implements ParserWidget */
+int WidgetPrevhref(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
+	char name[64];
+	(void)f;
+	if(w->page <= 1) return 0;
+	WidgetPageName(&name, w->page - 1);
+	TextString(out, name);
 	return 0;
 }
-/** Writes to `fp` the path of `f`. @implements ParserWidget */
-int WidgetPwd(struct Files *const f, FILE *const fp) {
-	static int persistant = 0; /* ick, be very careful! */
+/** Writes to `out` the path of `f`, or of the news in `w` if it came from a
+ feed. @implements ParserWidget */
+int WidgetPwd(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
 	const char *pwd;
-	/* fixme: Const-correctness! You can't do that. */
-	if(!persistant) { persistant = 1; FilesSetPath((struct Files *)f); }
+	if(w->news.dir) { /* the news came from a feed; "a/b/" */
+		const char *const a = w->news.dir + w->at, *b;
+		if(!*a || !(b = strchr(a, '/'))) { w->at = 0; return 0; }
+		TextCat(out, a, (size_t)(b - a));
+		w->at = (size_t)(b + 1 - w->news.dir);
+		return -1;
+	}
+	if(!w->pwd) { w->pwd = 1; FilesSetPath(f); }
 	pwd = FilesEnumPath(f);
-	if(!pwd)        { persistant = 0;  return 0; }
-	fprintf(fp, "%s", pwd);
+	if(!pwd)    { w->pwd = 0; return 0; }
+	TextString(out, pwd);
 	return -1;
 }
-/** Writes to `fp` the path of `f` in reverse. @implements ParserWidget */
-int WidgetRoot(struct Files *const f, FILE *const fp) {
-	static int persistant = 0; /* ick, be very careful! */
+/** Writes to `out` the path of `f` in reverse. @implements ParserWidget */
+int WidgetRoot(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
 	const char *pwd;
-	if(!persistant) { persistant = 1; FilesSetPath((struct Files *)f); }
+	if(!w->root) { w->root = 1; FilesSetPath(f); }
 	pwd = FilesEnumPath(f);
-	if(!pwd)        { persistant = 0;  return 0; }
-	fprintf(fp, "%s", dir_parent);
+	if(!pwd)     { w->root = 0; return 0; }
+	TextString(out, dir_parent);
 	return -1;
 }
-/** Ignores `f`. Writes to `fp` the current global title.
+/** Ignores `f`. Writes to `out` the title of the current news in `w`.
  @implements ParserWidget */
-int WidgetTitle(struct Files *const f, FILE *const fp) {
+int WidgetTitle(struct Files *const f, struct Text *const out,
+	struct Widget *const w) {
 	(void)f;
-	fprintf(fp, "%s", title);
+	TextString(out, w->news.title);
 	return 0;
 }
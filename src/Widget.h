@@ -1,23 +1,77 @@
-extern const char *dot_desc, *dot_news;
+extern const char *html_desc, *dot_desc, *dot_news, *dot_link, *icon_dir,
+	*icon_file;
 
-struct Recursor;
 struct Files;
+struct Text;
+struct Images;
 
-void WidgetSetRecursor(const struct Recursor *recursor);
-int WidgetSetNews(const char *fn);
+/** The state the widgets keep while rendering; there's one for every
+ directory being rendered, so they can be rendered at the same time. */
+struct Widget {
+	struct { int year, month, day; char title[64], name[64];
+		const char *dir, *body; size_t size; } news; /* `dir`, `body` in feed */
+	int pwd, root; /* in the middle of enumerating the path */
+	size_t at; /* in the middle of enumerating `news.dir` */
+	const char *now; /* the time of the build */
+	struct Images *images; /* the sizes of the icons, or null */
+	size_t page, pages; /* of the index, from one, set after clearing */
+	int link; /* in the middle of `@(prev)` or `@(next)` */
+};
+
+int WidgetSetNow(char (*const now)[24]);
+void WidgetClear(struct Widget *const w, const char *const now,
+	struct Images *const images);
+void WidgetPageName(char (*const name)[64], const size_t page);
+int WidgetSetNews(struct Widget *const w, struct Files *const f,
+	const char *fn);
 /* the widget handlers */
-int WidgetDate(struct Files *const f, FILE *const fp);
-int WidgetContent(struct Files *const f, FILE *const fp);
-int WidgetFilealt(struct Files *const f, FILE *const fp);
-int WidgetFiledesc(struct Files *const f, FILE *const fp);
-int WidgetFilehref(struct Files *const f, FILE *const fp);
-int WidgetFileicon(struct Files *const f, FILE *const fp);
-int WidgetFilename(struct Files *const f, FILE *const fp);
-int WidgetFiles(struct Files *const f, FILE *const fp);
-int WidgetFilesize(struct Files *const f, FILE *const fp);
-int WidgetNews(struct Files *const f, FILE *const fp);
-int WidgetNewsname(struct Files *const f, FILE *const fp);
-int WidgetNow(struct Files *const f, FILE *const fp);
-int WidgetPwd(struct Files *const f, FILE *const fp);
-int WidgetRoot(struct Files *const f, FILE *const fp);
-int WidgetTitle(struct Files *const f, FILE *const fp);
+int WidgetDate(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetDircount(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetContent(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetFilealt(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetFiledesc(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetFilehref(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetFileicon(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetFilename(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetFiles(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetFilesize(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetIconheight(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetIconwidth(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetLastmod(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetNews(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetNewsname(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetNext(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetNexthref(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetNow(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetPage(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetPages(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetPrev(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetPrevhref(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetPwd(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetRoot(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
+int WidgetTitle(struct Files *const f, struct Text *const out,
+	struct Widget *const w);
@@ -0,0 +1,245 @@
+/** @license 2026 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle Writer
+ @author Neil
+
+ A `Writer` is threads that publish the pages that are rendered somewhere
+ else, so that reading the next directory doesn't wait for the file-system.
+ <fn:WriterPut> takes the `Text` of a page, and gives back an empty one, so
+ nothing is copied; the `Text` are used again when they've been written. It
+ has room for so many pages, and so many bytes, and past that, it waits, so
+ it's never more than that behind. With `gzip`, the compressed sibling is
+ made on the writer, too. <fn:WriterWait> waits for all of them, and says if
+ any couldn't be written.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h> /* malloc free */
+#include <stdio.h>  /* perror */
+#include <string.h> /* strcpy strcat strlen */
+#include <unistd.h> /* close faccessat */
+#include <fcntl.h>  /* AT_ */
+#include <errno.h>
+#include <pthread.h>
+#include <assert.h>
+#include "Text.h"
+#include "Stats.h"
+#include "Writer.h"
+
+/* constants */
+static const size_t writer_pages = 64;
+static const size_t writer_bytes = 16 << 20;
+
+/* A page to write to `name` in `dirfd`, which is it's own. */
+struct Item {
+	struct Item *next;
+	int dirfd;
+	char name[64 + 8];
+	struct Text *page;
+};
+
+/* Every thread has it's own compressed page and time. */
+struct Thread {
+	struct Writer *w;
+	pthread_t thread;
+	struct Text *gz;
+	struct Stats *stats;
+};
+
+/* public */
+struct Writer {
+	int gzip, is_end;
+	struct Stats *stats; /* the total, or null */
+	pthread_mutex_t lock; /* protects the following */
+	int error; /* sticky; why a page wasn't written, or zero */
+	pthread_cond_t item, room;
+	struct { struct Item *head, **tail; size_t size, bytes; } queue;
+	struct Item *spare; /* written, to use again */
+	struct { struct Thread *data; size_t size; } thread;
+};
+
+/** Publishes `it` with `t`; with `gzip`, also it's compressed sibling, if the
+ page changed or it's not there. @return Success; the reason is on `stderr`. */
+static int publish(const struct Writer *const w, struct Thread *const t,
+	struct Item *const it) {
+	char name_gz[sizeof it->name + 8];
+	const double start = StatsStart(t->stats);
+	int written = 0, gz = 0, e = 0;
+	if(!TextPublish(it->page, it->dirfd, it->name, &written))
+		{ e = errno; perror(it->name); goto finally; }
+	if(written) StatsBytes(t->stats, (unsigned long)TextSize(it->page));
+	strcpy(name_gz, it->name), strcat(name_gz, dot_gz);
+	if(!w->gzip || !written && !faccessat(it->dirfd, name_gz, F_OK, 0))
+		goto finally;
+	if(!TextGzip(it->page, t->gz)
+		|| !TextPublish(t->gz, it->dirfd, name_gz, &gz))
+		{ e = errno; perror(name_gz); goto finally; }
+	if(gz) StatsBytes(t->stats, (unsigned long)TextSize(t->gz));
+finally:
+	StatsStop(t->stats, StatsWrite, start, (unsigned long)(!!written + !!gz));
+	if(!e) return 1;
+	errno = e; /* perror can change it */
+	return 0;
+}
+
+/** Thread entry; writes what's in the queue until it's empty at the end. */
+static void *work(void *const param) {
+	struct Thread *const t = param;
+	struct Writer *const w = t->w;
+	struct Item *it;
+	size_t size;
+	int e;
+	for( ; ; ) {
+		pthread_mutex_lock(&w->lock);
+		while(!(it = w->queue.head) && !w->is_end)
+			pthread_cond_wait(&w->item, &w->lock);
+		if(!it) { pthread_mutex_unlock(&w->lock); break; }
+		if(!(w->queue.head = it->next)) w->queue.tail = &w->queue.head;
+		pthread_mutex_unlock(&w->lock);
+		size = TextSize(it->page);
+		e = publish(w, t, it) ? 0 : errno;
+		if(close(it->dirfd) && (e = errno)) perror(it->name);
+		TextClear(it->page);
+		pthread_mutex_lock(&w->lock);
+		if(e && !w->error) w->error = e;
+		it->next = w->spare, w->spare = it;
+		w->queue.size--, w->queue.bytes -= size;
+		pthread_cond_signal(&w->room);
+		pthread_mutex_unlock(&w->lock);
+	}
+	return 0;
+}
+
+/** Lets the threads of `w` finish what's in the queue and joins them; the
+ time it took is added to the `stats` it was given. Nothing more can be put. */
+static void join(struct Writer *const w) {
+	size_t i;
+	pthread_mutex_lock(&w->lock);
+	w->is_end = 1;
+	pthread_cond_broadcast(&w->item);
+	pthread_mutex_unlock(&w->lock);
+	for(i = 0; i < w->thread.size; i++) {
+		struct Thread *const t = w->thread.data + i;
+		pthread_join(t->thread, 0);
+		if(!StatsMerge(w->stats, t->stats)) perror("stats");
+		Stats_(&t->stats);
+		Text_(&t->gz);
+	}
+	w->thread.size = 0;
+}
+
+/** Waits for everything in `w` to be written, then destructs it; see
+ <fn:WriterWait> to know if it was. */
+void Writer_(struct Writer **const w_ptr) {
+	struct Writer *w;
+	struct Item *it;
+	if(!w_ptr || !(w = *w_ptr)) return;
+	join(w);
+	/* if there were no threads */
+	while((it = w->queue.head)) {
+		w->queue.head = it->next;
+		close(it->dirfd);
+		Text_(&it->page);
+		free(it);
+	}
+	while((it = w->spare)) w->spare = it->next, Text_(&it->page), free(it);
+	pthread_cond_destroy(&w->room);
+	pthread_cond_destroy(&w->item);
+	pthread_mutex_destroy(&w->lock);
+	free(w->thread.data);
+	free(w);
+	*w_ptr = 0;
+}
+
+/** @return A writer on `threads`, that makes the compressed siblings with
+ `gzip`, and adds the time it took to `stats`, if it's not null, or null.
+ @throws[malloc, pthread_mutex_init, pthread_cond_init, pthread_create] */
+struct Writer *Writer(const unsigned threads, const int gzip,
+	struct Stats *const stats) {
+	struct Writer *w;
+	assert(threads);
+	if(!(w = malloc(sizeof *w))) return 0;
+	w->gzip = gzip, w->is_end = 0, w->error = 0;
+	w->stats = stats;
+	w->queue.head = 0, w->queue.tail = &w->queue.head;
+	w->queue.size = w->queue.bytes = 0;
+	w->spare = 0;
+	w->thread.size = 0;
+	if(!(w->thread.data = malloc(sizeof *w->thread.data * threads)))
+		{ free(w); return 0; }
+	if((errno = pthread_mutex_init(&w->lock, 0)))
+		{ free(w->thread.data); free(w); return 0; }
+	if((errno = pthread_cond_init(&w->item, 0))) {
+		pthread_mutex_destroy(&w->lock);
+		free(w->thread.data); free(w); return 0;
+	}
+	if((errno = pthread_cond_init(&w->room, 0))) {
+		pthread_cond_destroy(&w->item), pthread_mutex_destroy(&w->lock);
+		free(w->thread.data); free(w); return 0;
+	}
+	while(w->thread.size < threads) {
+		struct Thread *const t = w->thread.data + w->thread.size;
+		t->w = w, t->gz = 0, t->stats = 0;
+		if(gzip && !(t->gz = Text())
+			|| stats && !(t->stats = Stats(0))) goto catch;
+		if((errno = pthread_create(&t->thread, 0, &work, t))) goto catch;
+		w->thread.size++;
+		continue;
+catch:
+		{ const int e = errno; Text_(&t->gz), Stats_(&t->stats);
+		Writer_(&w); errno = e; return 0; }
+	}
+	return w;
+}
+
+/** Queues the `page` to be written to `name` in `dirfd`, which is duplicated,
+ in `w`; `page` is replaced by an empty one. If there's no room, it waits.
+ @return Success, (not of the writing, see <fn:WriterWait>.)
+ @throws[malloc, dup] */
+int WriterPut(struct Writer *const w, const int dirfd, const char *const name,
+	struct Text **const page) {
+	struct Item *it;
+	struct Text *empty;
+	size_t size;
+	assert(w && name && page && *page && strlen(name) < sizeof it->name);
+	pthread_mutex_lock(&w->lock);
+	while(w->queue.size && (w->queue.size >= writer_pages
+		|| w->queue.bytes >= writer_bytes))
+		pthread_cond_wait(&w->room, &w->lock);
+	if((it = w->spare)) w->spare = it->next;
+	pthread_mutex_unlock(&w->lock);
+	if(!it) {
+		if(!(it = malloc(sizeof *it))) return 0;
+		if(!(it->page = Text())) { free(it); return 0; }
+	}
+	if((it->dirfd = dup(dirfd)) == -1) {
+		pthread_mutex_lock(&w->lock);
+		it->next = w->spare, w->spare = it;
+		pthread_mutex_unlock(&w->lock);
+		return 0;
+	}
+	strcpy(it->name, name);
+	/* the empty one goes back to the caller */
+	empty = it->page, it->page = *page, *page = empty;
+	size = TextSize(it->page);
+	it->next = 0;
+	pthread_mutex_lock(&w->lock);
+	*w->queue.tail = it, w->queue.tail = &it->next;
+	w->queue.size++, w->queue.bytes += size;
+	pthread_cond_signal(&w->item);
+	pthread_mutex_unlock(&w->lock);
+	return 1;
+}
+
+/** Waits for everything in `w` to be written; after, nothing more can be put.
+ @return Whether every page was written; the pages are on `stderr`.
+ @throws[open, write, rename] The first reason one wasn't. */
+int WriterWait(struct Writer *const w) {
+	assert(w);
+	join(w);
+	if(!w->error) return 1;
+	errno = w->error;
+	return 0;
+}
@@ -0,0 +1,10 @@
+struct Writer;
+struct Text;
+struct Stats;
+
+struct Writer *Writer(const unsigned threads, const int gzip,
+	struct Stats *const stats);
+void Writer_(struct Writer **const w_ptr);
+int WriterPut(struct Writer *const w, const int dirfd, const char *const name,
+	struct Text **const page);
+int WriterWait(struct Writer *const w);
@@ -0,0 +1,205 @@
+/** @license 2000, 2012 Neil Edelman, distributed under the terms of the
+ [GNU General Public License 3](https://opensource.org/licenses/GPL-3.0).
+
+ @subtitle make-index
+ @author Neil
+
+ The command-line of `make-index`; it makes a <fn:MakeIndex> of the working
+ directory, and builds it, watches it, or serves it.
+
+ There should be an `example` directory that has a bunch of files in it. Run
+ `../bin/make-index` in the example directory; it should make a webpage out of
+ the directory structure and the templates.
+
+ @std POSIX.1-2008 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>		/* strtoul EXIT_ */
+#include <stdio.h>		/* fprintf FILE */
+#include <string.h>		/* strcmp */
+#include <sys/types.h>	/* mode_t (umask) */
+#include <sys/stat.h>	/* umask */
+#include <errno.h>		/* EDOM */
+#include <signal.h>		/* sigaction */
+#include "MakeIndex.h"
+
+/* in MakeIndex.c */
+extern const char *html_index, *xml_sitemap, *rss_newsfeed, *template_index,
+	*template_sitemap, *template_newsfeed, *snapshot_file;
+extern const size_t news_max;
+/* in Files.c */
+extern const char *dir_current;
+
+/* Whether `--watch` or `--serve` has been asked to stop. */
+static volatile sig_atomic_t is_interrupted;
+
+/** Stops `--watch` or `--serve` after the one it's on. */
+static void interrupt(int sig) { (void)sig, is_interrupted = 1; }
+
+static void usage(void) {
+	static const char *programme = "make-index";
+	fprintf(stderr,
+		"%s is a content management system that generates static\n"
+		"content on all the directories rooted at the current directory.\n\n"
+		"Usage: %s [--incremental] [-j threads] [--io-uring] [--gzip]\n"
+		"	[--news items] [--page files] [--output dir]\n"
+		"	[--watch | --serve address | --compile] [--stats] [--profile]\n"
+		"	[-v]\n\n", programme, programme);
+	fprintf(stderr,
+		"If you have these files accessible in the current directory, then,\n"
+		"<%s>\tcreates <%s> in all accessible subdirectories,\n"
+		"<%s>\tcreates <%s> from the newest .news encountered,\n"
+		"<%s>\tcreates <%s> of all accessible subdirectories.\n",
+		template_index, html_index,
+		template_newsfeed, rss_newsfeed,
+		template_sitemap, xml_sitemap);
+	fputs(
+		"Any other <.name.ext> creates <name.ext> in all accessible\n"
+		"subdirectories, or, if it's <head>~<body>~<tail>, like the last two,\n"
+		"one with the body for every directory, or, if it has @(date),\n"
+		"@(news), @(newsname), or @(title) in it, every news item; they are\n"
+		"all made in the same pass.\n\n", stderr);
+	fprintf(stderr,
+		"With --incremental, <%s> is a snapshot of the last run, and only the\n"
+		"<%s> whose directory or descriptions changed are written.\n"
+		"With -j, the directories are read and written on that many threads.\n"
+		"With --io-uring, the status and descriptions of a directory are read\n"
+		"in one batch, if the system has it.\n"
+		"With --gzip, there is also a compressed <file>.gz of each output,\n"
+		"which is made again only when <file> changes.\n",
+		snapshot_file, html_index);
+	fprintf(stderr,
+		"With --news, the newsfeed has that many of the newest items, (%lu.)\n"
+		"With --page, a directory with more files than that is split into\n"
+		"<%s>, <index-2.html>, and so on, with @(page), @(pages), and\n"
+		"@(prev){@(prevhref)} and @(next){@(nexthref)} to get around;\n"
+		"they are recorded in <%s>, and only those are taken away\n"
+		"when there are fewer.\n",
+		(unsigned long)news_max, html_index, snapshot_file);
+	fputs(
+		"With --output, the outputs are written under that directory, in the\n"
+		"same structure, and nothing is written in the current directory; if\n"
+		"it's in the current directory, it's left out.\n"
+		"With --watch, it builds everything on one thread and stays, building\n"
+		"again the directories that change, until interrupted, (Linux.)\n",
+		stderr);
+	fprintf(stderr,
+		"With --serve, nothing is written; the <%s> of a directory is\n"
+		"rendered when it's asked for by HTTP, until interrupted, at <dir>/\n"
+		"on the address, which is a port on the loopback or a Unix socket.\n"
+		"With --compile, nothing is written; the templates are C on standard\n"
+		"output, for `make aot`, which builds make-index-aot that runs them\n"
+		"directly, and any other templates as usual.\n", html_index);
+	fputs(
+		"With --stats, a report of where the time went is written in JSON to\n"
+		"standard output at the end. With --profile, every widget in the\n"
+		"templates is counted and timed, by line, and written to stderr at\n"
+		"the end, slowest first. With -v, every directory is on stderr.\n"
+		"Files that would be written the same are not touched. @(now) is the\n"
+		"start of the run, or SOURCE_DATE_EPOCH, if it's set.\n\n", stderr);
+	fprintf(stderr, "Of special significance:\n"
+		" <file>.d is a description of <file>;\n"
+		"  if this description is empty or has a leading blank line,\n"
+		"  it skips over this file;\n"
+		" index.d is a description of the directory;\n"
+		" content.d is an in-depth description of the directory;\n"
+		" <file>.d.jpg is an (icon) image that will go with the description;\n"
+		" <news>.news as a newsworthy item; the format of this file is\n"
+		"  ISO 8601 date (YYYY-MM-DD,) next line title;\n");
+	fputs(
+		" <link>.link as a link with the href in the file;\n"
+		" .indexignore has globs, like .gitignore, of files that are left\n"
+		"  out of the directory and the ones under it; directories that are\n"
+		"  left out are never read.\n\n", stderr);
+	fprintf(stderr,
+		"2000, 2012 Neil Edelman, distributed under the terms of the\n"
+		"GNU General Public License 3.\n\n");
+}
+
+/** Make sure that `argc`, `argv`, aren't expecting user input. */
+int main(int argc, char **argv) {
+	struct MakeIndexOptions option;
+	struct MakeIndex *mi = 0;
+	struct sigaction sa;
+	const char *why = 0, *serve = 0;
+	int ret = EXIT_FAILURE, watch = 0, compile = 0, i;
+	option.incremental = option.uring = option.gzip = option.verbose
+		= option.stats = option.profile = 0;
+	option.threads = 0;
+	option.news = 0;
+	option.page = 0;
+	option.cache = 0;
+	option.output = 0;
+	for(i = 1; i < argc; i++) {
+		if(!strcmp(argv[i], "--incremental")) option.incremental = 1;
+		else if(!strcmp(argv[i], "--io-uring")) option.uring = 1;
+		else if(!strcmp(argv[i], "--gzip")) option.gzip = 1;
+		else if(!strcmp(argv[i], "--watch")) watch = 1;
+		else if(!strcmp(argv[i], "--compile")) compile = 1;
+		else if(!strcmp(argv[i], "--stats")) option.stats = 1;
+		else if(!strcmp(argv[i], "--profile")) option.profile = 1;
+		else if(!strcmp(argv[i], "-v")) option.verbose = 1;
+		else if(!strcmp(argv[i], "--serve")) {
+			if(++i >= argc) { why = "--serve"; errno = EDOM; goto catch; }
+			serve = argv[i];
+		}
+		else if(!strcmp(argv[i], "--output")) {
+			if(++i >= argc || !*argv[i])
+				{ why = "--output"; errno = EDOM; goto catch; }
+			option.output = argv[i];
+		}
+		else if(!strcmp(argv[i], "--news")) {
+			char *end;
+			unsigned long news;
+			if(++i >= argc || (news = strtoul(argv[i], &end, 10), *end)
+				|| !news) { why = "--news"; errno = EDOM; goto catch; }
+			option.news = (size_t)news;
+		}
+		else if(!strcmp(argv[i], "--page")) {
+			char *end;
+			unsigned long page;
+			if(++i >= argc || (page = strtoul(argv[i], &end, 10), *end)
+				|| !page) { why = "--page"; errno = EDOM; goto catch; }
+			option.page = (size_t)page;
+		}
+		else if(!strncmp(argv[i], "-j", 2)) {
+			const char *const n = argv[i][2] ? argv[i] + 2 : argv[++i];
+			char *end;
+			unsigned long threads;
+			if(!n || (threads = strtoul(n, &end, 10), *end) || !threads
+				|| threads > 1024) { why = "-j"; errno = EDOM; goto catch; }
+			option.threads = (unsigned)threads;
+		} else { why = argv[i]; errno = EDOM; goto catch; }
+	}
+	if(watch && serve) { why = "--serve"; errno = EDOM; goto catch; }
+	if(compile && (watch || serve))
+		{ why = "--compile"; errno = EDOM; goto catch; }
+	/* make sure that umask is set so that others can read what we create */
+	umask((mode_t)(S_IWGRP | S_IWOTH));
+	/* `MakeIndex` says why itself */
+	if(!(mi = MakeIndex(dir_current, &option))) goto catch;
+	if(compile) {
+		if(!MakeIndexCompile(mi, stdout) || fflush(stdout))
+			{ why = "--compile"; goto catch; }
+	} else if(watch || serve) {
+		sa.sa_handler = &interrupt;
+		sigemptyset(&sa.sa_mask);
+		sa.sa_flags = 0;
+		if(sigaction(SIGINT, &sa, 0) || sigaction(SIGTERM, &sa, 0))
+			{ why = "sigaction"; goto catch; }
+		if(!(watch ? MakeIndexWatch(mi, &is_interrupted)
+			: MakeIndexServe(mi, serve, &is_interrupted))) goto catch;
+	} else if(!MakeIndexBuild(mi)) goto catch;
+	ret = EXIT_SUCCESS;
+	goto finally;
+catch:
+	if(why) perror(why);
+	fputc('\n', stdout);
+	usage();
+finally:
+	if(mi && option.stats && !MakeIndexReport(mi, stdout)) perror("stats");
+	if(mi && option.profile && !MakeIndexProfile(mi, stderr))
+		perror("profile");
+	MakeIndex_(&mi);
+	return ret;
+}